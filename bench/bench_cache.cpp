@@ -0,0 +1,97 @@
+// Query cache benchmark: a stream of car / metro / all queries between transit stops
+// with a few popular pairs (Zipf-like), answered without the cache, with the cache and
+// with one-to-all trees for hot endpoints, checking that every cached cost is the one
+// the search finds; then a small memory cap and a graph change
+//
+// usage: bench_cache [dataDir] [queries] [seed]
+#include "../common/cache.h"
+#include <chrono>
+#include <random>
+
+double msSince(chrono::steady_clock::time_point t0) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+}
+
+int main(int argc, char** argv) {
+    string basePath = argc > 1 ? argv[1] : "/media/nym/Nym_s Files/grph-project/";
+    if (!basePath.empty() && basePath.back() != '/') basePath += "/";
+    int numQueries = argc > 2 ? atoi(argv[2]) : 2000;
+    int seed = argc > 3 ? atoi(argv[3]) : 1;
+    
+    Graph graph;
+    loadGraph(graph, {
+        {basePath + "Roadmap-Dhaka.csv", 0},
+        {basePath + "Routemap-DhakaMetroRail.csv", 1},
+        {basePath + "Routemap-BikolpoBus.csv", 2},
+        {basePath + "Routemap-UttaraBus.csv", 3}
+    }, basePath + "graph.snap");
+    if (graph.nodeCount == 0) {
+        cout << "No graph data found in " << basePath << "\n";
+        return 1;
+    }
+    graph.buildSpatialIndex();
+    
+    // stops ranked by popularity: the k-th is drawn with weight 1 / (k + 1)
+    vector<int> stops;
+    for (int u = 0; u < graph.nodeCount; u++) {
+        if (graph.nodes[u].isStop) stops.push_back(u);
+    }
+    mt19937 rng(seed);
+    shuffle(stops.begin(), stops.end(), rng);
+    vector<double> weights;
+    for (size_t k = 0; k < stops.size(); k++) weights.push_back(1.0 / (k + 1));
+    discrete_distribution<int> popular(weights.begin(), weights.end());
+    uniform_int_distribution<int> type(Q_CAR, Q_ALL);
+    vector<Query> queries(numQueries);
+    for (Query& q : queries) {
+        const Node& a = graph.nodes[stops[popular(rng)]];
+        const Node& b = graph.nodes[stops[popular(rng)]];
+        q.type = type(rng);
+        q.srcLon = a.lon;
+        q.srcLat = a.lat;
+        q.dstLon = b.lon;
+        q.dstLat = b.lat;
+    }
+    
+    SearchWorkspace ws;
+    vector<double> expected;
+    auto t0 = chrono::steady_clock::now();
+    for (const Query& q : queries) expected.push_back(answerQuery(graph, q, ws).cost);
+    double plainMs = msSince(t0);
+    cout << numQueries << " queries over " << stops.size() << " stops\n" << fixed << setprecision(3);
+    cout << "  no cache          " << plainMs / numQueries << " ms/query\n";
+    
+    bool allOk = true;
+    auto run = [&](string label, QueryCache& cache) {
+        int bad = 0;
+        auto t0 = chrono::steady_clock::now();
+        for (size_t i = 0; i < queries.size(); i++) {
+            QueryResult r = answerCached(graph, queries[i], ws, &cache);
+            bad += fabs(r.cost - expected[i]) > 1e-9 * max(1.0, fabs(r.cost));
+        }
+        double ms = msSince(t0);
+        cout << "  " << left << setw(18) << label << right << ms / numQueries << " ms/query, " << setprecision(1)
+             << plainMs / ms << "x   " << cache.hits << " hits, " << cache.treeHits << " tree hits, " << cache.misses
+             << " misses, " << cache.trees << " trees, " << cache.evictions << " evictions, " << cache.entries()
+             << " entries in " << cache.bytes() / 1048576.0 << " MB, " << bad << " wrong\n" << setprecision(3);
+        allOk = allOk && bad == 0;
+    };
+    
+    QueryCache routes(64 << 20, 0);
+    run("routes only", routes);
+    QueryCache withTrees(64 << 20, 4);
+    run("routes + trees", withTrees);
+    QueryCache small(2 << 20, 4);
+    run("2 MB cap", small);
+    allOk = allOk && small.bytes() <= (2 << 20);
+    
+    // a change to the graph must empty the cache before the next answer
+    graph.revision++;
+    long long hitsBefore = withTrees.hits + withTrees.treeHits;
+    QueryResult r = answerCached(graph, queries[0], ws, &withTrees);
+    bool flushed = withTrees.flushes == 1 && withTrees.hits + withTrees.treeHits == hitsBefore;
+    cout << "  graph changed: " << (flushed ? "flushed" : "NOT flushed") << ", " << withTrees.entries()
+         << " entries after one more query\n";
+    allOk = allOk && flushed && fabs(r.cost - expected[0]) <= 1e-9 * max(1.0, fabs(r.cost));
+    return allOk ? 0 : 1;
+}
@@ -0,0 +1,127 @@
+// Contraction Hierarchy benchmark: preprocessing time, hierarchy size and car query
+// latency against plain Dijkstra on the same random node pairs
+//
+// usage: bench_ch [dataDir] [queries] [seed]
+#include "../common/ch.h"
+#include <chrono>
+#include <random>
+
+double msSince(chrono::steady_clock::time_point t0) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+}
+
+double percentile(vector<double> v, double p) {
+    if (v.empty()) return 0;
+    sort(v.begin(), v.end());
+    return v[min(v.size() - 1, (size_t)(p * v.size()))];
+}
+
+void report(string label, const vector<double>& ms, long long settled) {
+    double total = 0;
+    for (double t : ms) total += t;
+    cout << left << setw(12) << label << fixed << setprecision(4)
+         << "mean " << setw(10) << total / ms.size() << " ms  "
+         << "p50 " << setw(10) << percentile(ms, 0.5) << " ms  "
+         << "p99 " << setw(10) << percentile(ms, 0.99) << " ms  "
+         << setprecision(0) << (double)settled / ms.size() << " settled/query\n";
+}
+
+int main(int argc, char** argv) {
+    string basePath = argc > 1 ? argv[1] : "/media/nym/Nym_s Files/grph-project/";
+    if (!basePath.empty() && basePath.back() != '/') basePath += "/";
+    int numQueries = argc > 2 ? atoi(argv[2]) : 1000;
+    int seed = argc > 3 ? atoi(argv[3]) : 1;
+    
+    Graph graph;
+    loadGraph(graph, {
+        {basePath + "Roadmap-Dhaka.csv", 0},
+        {basePath + "Routemap-DhakaMetroRail.csv", 1},
+        {basePath + "Routemap-BikolpoBus.csv", 2},
+        {basePath + "Routemap-UttaraBus.csv", 3}
+    }, basePath + "graph.snap");
+    if (graph.nodeCount == 0) {
+        cout << "No graph data found in " << basePath << "\n";
+        return 1;
+    }
+    
+    int carEdges = 0;
+    vector<int> carNodes;
+    for (int u = 0; u < graph.nodeCount; u++) {
+        int deg = graph.edgeEnd(u, 0) - graph.edgeBegin(u, 0);
+        carEdges += deg;
+        if (deg > 0) carNodes.push_back(u);
+    }
+    cout << graph.nodeCount << " nodes, " << carNodes.size() << " with car edges, " << carEdges / 2 << " car edges\n\n";
+    
+    ContractionHierarchy ch;
+    auto t0 = chrono::steady_clock::now();
+    ch.build(graph);
+    double buildMs = msSince(t0);
+    string chFile = basePath + "graph.ch";
+    ch.save(chFile);
+    
+    ContractionHierarchy loaded;
+    t0 = chrono::steady_clock::now();
+    bool ok = loaded.load(chFile, graph);
+    double loadMs = msSince(t0);
+    MappedFile file(chFile);
+    
+    cout << fixed << setprecision(1);
+    cout << "build       " << buildMs << " ms\n";
+    cout << "load        " << loadMs << " ms" << (ok ? "" : " (FAILED)") << "\n";
+    cout << "hierarchy   " << ch.edges.size() << " edges (" << ch.shortcutCount() << " shortcuts), "
+         << file.size / 1024.0 << " KB on disk\n\n";
+    
+    mt19937 rng(seed);
+    uniform_int_distribution<int> pick(0, (int)carNodes.size() - 1);
+    vector<pair<int,int>> pairs(numQueries);
+    for (auto& p : pairs) p = {carNodes[pick(rng)], carNodes[pick(rng)]};
+    
+    SearchWorkspace ws;
+    vector<double> dijkstraMs, chMs;
+    long long dijkstraSettled = 0, chSettled = 0;
+    int mismatches = 0, pathErrors = 0;
+    // each engine runs over all pairs in turn so neither sees the other's cache footprint
+    vector<CostResult> expected;
+    for (auto [s, t] : pairs) {
+        auto q0 = chrono::steady_clock::now();
+        expected.push_back(cheapestRoute(graph, s, t, CAR_PER_KM, CAR_ONLY, ws));
+        dijkstraMs.push_back(msSince(q0));
+        dijkstraSettled += expected.back().settled;
+    }
+    for (int i = 0; i < numQueries; i++) {
+        auto [s, t] = pairs[i];
+        auto q0 = chrono::steady_clock::now();
+        CostResult b = loaded.query(s, t, ws);
+        chMs.push_back(msSince(q0));
+        chSettled += b.settled;
+        
+        const CostResult& a = expected[i];
+        if ((a.cost < 0) != (b.cost < 0) || fabs(a.cost - b.cost) > 1e-9 * max(1.0, a.cost)) mismatches++;
+        
+        // the unpacked path must be a real car route of the reported length
+        double len = 0;
+        bool valid = b.cost < 0 || (b.path.front() == s && b.path.back() == t);
+        for (size_t k = 0; valid && k + 1 < b.path.size(); k++) {
+            double best = INF;
+            for (int e = graph.edgeBegin(b.path[k], 0); e < graph.edgeEnd(b.path[k], 0); e++) {
+                if (graph.edgeTo[e] == b.path[k + 1]) best = min(best, (double)graph.edgeDist[e]);
+            }
+            valid = best < INF;
+            len += best;
+        }
+        if (!valid || (b.cost >= 0 && fabs(len - b.cost) > 1e-9 * max(1.0, b.cost))) pathErrors++;
+    }
+    
+    cout << numQueries << " random car queries (seed " << seed << "), "
+         << mismatches << " distance mismatches, " << pathErrors << " bad paths\n";
+    report("dijkstra", dijkstraMs, dijkstraSettled);
+    report("ch", chMs, chSettled);
+    
+    double dijkstraTotal = 0, chTotal = 0;
+    for (double t : dijkstraMs) dijkstraTotal += t;
+    for (double t : chMs) chTotal += t;
+    cout << "speedup     " << setprecision(1) << dijkstraTotal / chTotal << "x, build pays off after "
+         << setprecision(0) << buildMs / max(1e-9, (dijkstraTotal - chTotal) / numQueries) << " queries\n";
+    return mismatches == 0 && pathErrors == 0 ? 0 : 1;
+}
@@ -0,0 +1,142 @@
+// Compact storage benchmark: memory of the frozen graph by part, per node and per edge,
+// in the storage mode this was built with (build it once as it is and once with
+// -DCOMPACT_GRAPH to compare), load times, the exactness guard's counts, and car /
+// all-mode searches between random nodes with the gap between the lengths the search
+// added and the exact lengths a printed route shows. The route digest at the end is the
+// same in both builds when they find the same routes.
+//
+// usage: bench_compact [dataDir] [queries] [seed]
+#include "../common/routing.h"
+#include "../common/snapshot.h"
+#include <chrono>
+#include <random>
+
+double msSince(chrono::steady_clock::time_point t0) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+}
+
+template <class T>
+size_t vectorBytes(const vector<T>& v) { return v.capacity() * sizeof(T); }
+
+// nodes of a node-based hash table plus its bucket array
+template <class M>
+size_t mapBytes(const M& m) {
+    return m.size() * (sizeof(typename M::value_type) + 2 * sizeof(void*)) + m.bucket_count() * sizeof(void*);
+}
+
+size_t gridBytes(const SpatialGrid& g) {
+    return vectorBytes(g.cellStart) + vectorBytes(g.ids) + vectorBytes(g.lats) + vectorBytes(g.lons);
+}
+
+int main(int argc, char** argv) {
+    string basePath = argc > 1 ? argv[1] : "/media/nym/Nym_s Files/grph-project/";
+    if (!basePath.empty() && basePath.back() != '/') basePath += "/";
+    int numQueries = argc > 2 ? atoi(argv[2]) : 300;
+    int seed = argc > 3 ? atoi(argv[3]) : 1;
+    vector<GraphSource> sources = {
+        {basePath + "Roadmap-Dhaka.csv", 0},
+        {basePath + "Routemap-DhakaMetroRail.csv", 1},
+        {basePath + "Routemap-BikolpoBus.csv", 2},
+        {basePath + "Routemap-UttaraBus.csv", 3}
+    };
+    
+    auto t0 = chrono::steady_clock::now();
+    Graph parsed;
+    for (auto& src : sources) {
+        if (src.mode == 0) loadRoads(parsed, src.file);
+        else loadTransport(parsed, src.file, src.mode);
+    }
+    parsed.freeze();
+    double parseMs = msSince(t0);
+    if (parsed.nodeCount == 0) {
+        cout << "No graph data found in " << basePath << "\n";
+        return 1;
+    }
+    
+    Graph graph;
+    loadGraph(graph, sources, basePath + "graph.snap");
+    t0 = chrono::steady_clock::now();
+    Graph snapped;
+    bool fromSnapshot = loadGraph(snapped, sources, basePath + "graph.snap");
+    double snapMs = msSince(t0);
+    graph.buildSpatialIndex();
+
+#ifdef COMPACT_GRAPH
+    cout << "COMPACT_GRAPH storage\n";
+#else
+    cout << "default storage\n";
+#endif
+    int n = graph.nodeCount, m = graph.edgeTo.size();
+    cout << n << " nodes, " << m << " edge slots, " << graph.nodeNames.size() << " named nodes, " << graph.names.size()
+         << " distinct names\n" << fixed << setprecision(1);
+    cout << "  load: " << parseMs << " ms from CSV, " << snapMs << " ms from the snapshot"
+         << (fromSnapshot ? "" : " (not used)") << "\n";
+    
+    size_t grids = gridBytes(graph.grid);
+    for (int mode = 0; mode < NUM_MODES; mode++) grids += gridBytes(graph.modeGrid[mode]);
+    size_t names = mapBytes(graph.nameIds) + mapBytes(graph.nodeNames) + vectorBytes(graph.names);
+    for (const string& s : graph.names) names += s.capacity() + 1;
+    vector<pair<string, size_t>> parts = {
+        {"nodes", vectorBytes(graph.nodes)},
+        {"names", names},
+        {"node index", vectorBytes(graph.nodeMap.keys) + vectorBytes(graph.nodeMap.ids)},
+        {"edge starts", vectorBytes(graph.edgeStart)},
+        {"snapping grids", grids},
+        {"edge targets", vectorBytes(graph.edgeTo)},
+        {"edge lengths", vectorBytes(graph.edgeDist)},
+        {"exact lengths", mapBytes(graph.exactDist)}
+    };
+    size_t perNode = 0, perEdge = 0;
+    for (size_t i = 0; i < parts.size(); i++) {
+        cout << "  " << left << setw(16) << parts[i].first << right << setw(8) << parts[i].second / 1024.0 << " KB\n";
+        (i < 5 ? perNode : perEdge) += parts[i].second;
+    }
+    cout << "  per node " << (double)perNode / n << " bytes (Node " << sizeof(Node) << "), per edge slot "
+         << (double)perEdge / m << " bytes\n";
+    cout << "  guard: " << graph.roundedCoords << " coordinates rounded, " << graph.exactDist.size()
+         << " lengths kept exactly\n";
+    
+    // the parsed and the snapshot graph must agree slot by slot
+    int differ = snapped.nodeCount != n || (int)snapped.edgeTo.size() != m;
+    for (int u = 0; u < n && !differ; u++) {
+        differ += snapped.nodeName(u) != parsed.nodeName(u) || snapped.nodes[u].lat != parsed.nodes[u].lat ||
+                  snapped.nodes[u].lon != parsed.nodes[u].lon;
+        for (int i = parsed.edgeBegin(u, 0); i < parsed.edgeEnd(u, NUM_MODES - 1); i++) {
+            differ += snapped.edgeTo[i] != parsed.edgeTo[i] || snapped.exactLength(u, i) != parsed.exactLength(u, i);
+        }
+    }
+    cout << "  snapshot against CSV: " << differ << " differences\n";
+    
+    const double ALL_PER_KM[NUM_MODES] = {20, 5, 7, 10};
+    const bool ALL[NUM_MODES] = {true, true, true, true};
+    mt19937 rng(seed);
+    uniform_int_distribution<int> pick(0, n - 1);
+    SearchWorkspace ws;
+    double digest = 0, worst = 0;
+    int found = 0;
+    for (int pass = 0; pass < 2; pass++) {
+        const double* costPerKm = pass == 0 ? CAR_PER_KM : ALL_PER_KM;
+        const bool* allowed = pass == 0 ? CAR_ONLY : ALL;
+        double ms = 0;
+        for (int q = 0; q < numQueries; q++) {
+            int a = pick(rng), b = pick(rng);
+            t0 = chrono::steady_clock::now();
+            CostResult r = cheapestRoute(graph, a, b, costPerKm, allowed, ws);
+            ms += msSince(t0);
+            if (r.cost < 0) continue;
+            double exact = 0;
+            for (size_t k = 0; k + 1 < r.path.size(); k++) {
+                exact += stepLength(graph, r.path[k], r.path[k + 1], r.modes[k]) * costPerKm[r.modes[k]];
+            }
+            worst = max(worst, fabs(r.cost - exact) / max(1.0, exact));
+            digest += exact;
+            found++;
+        }
+        cout << "  " << (pass == 0 ? "car" : "all modes") << ": " << setprecision(3) << ms / numQueries
+             << " ms/query\n";
+    }
+    cout << "  " << found << " routes, largest relative gap between search cost and exact route cost "
+         << scientific << setprecision(1) << worst << "\n";
+    cout << "  route digest " << fixed << setprecision(9) << digest << "\n";
+    return differ == 0 && worst < 1e-6 ? 0 : 1;
+}
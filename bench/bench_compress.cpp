@@ -0,0 +1,105 @@
+// Chain compression benchmark: graph size before and after, and cheapestRoute on the
+// full graph against the compressed search for the car, metro and all-modes tables
+// with each search algorithm, checking costs and the expanded routes
+//
+// usage: bench_compress [dataDir] [queries] [seed]
+#include "../common/compress.h"
+#include "../common/query.h"
+#include <chrono>
+#include <random>
+
+double msSince(chrono::steady_clock::time_point t0) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+}
+
+// cost of a returned route, edge by edge; -1 if it uses an edge the graph lacks
+double routeCost(const Graph& graph, const CostResult& r, const double costPerKm[], const bool allowed[]) {
+    double total = 0;
+    for (size_t k = 0; k + 1 < r.path.size(); k++) {
+        int m = r.modes[k];
+        if (!allowed[m]) return -1;
+        double best = INF;
+        for (int e = graph.edgeBegin(r.path[k], m); e < graph.edgeEnd(r.path[k], m); e++) {
+            if (graph.edgeTo[e] == r.path[k + 1]) best = min(best, (double)graph.edgeDist[e]);
+        }
+        if (best >= INF) return -1;
+        total += best * costPerKm[m];
+    }
+    return total;
+}
+
+int main(int argc, char** argv) {
+    string basePath = argc > 1 ? argv[1] : "/media/nym/Nym_s Files/grph-project/";
+    if (!basePath.empty() && basePath.back() != '/') basePath += "/";
+    int numQueries = argc > 2 ? atoi(argv[2]) : 500;
+    int seed = argc > 3 ? atoi(argv[3]) : 1;
+    
+    Graph graph;
+    loadGraph(graph, {
+        {basePath + "Roadmap-Dhaka.csv", 0},
+        {basePath + "Routemap-DhakaMetroRail.csv", 1},
+        {basePath + "Routemap-BikolpoBus.csv", 2},
+        {basePath + "Routemap-UttaraBus.csv", 3}
+    }, basePath + "graph.snap");
+    if (graph.nodeCount == 0) {
+        cout << "No graph data found in " << basePath << "\n";
+        return 1;
+    }
+    
+    CompressedGraph cg;
+    auto t0 = chrono::steady_clock::now();
+    cg.build(graph);
+    double buildMs = msSince(t0);
+    cout << fixed << setprecision(1);
+    cout << "full        " << graph.nodeCount << " nodes, " << graph.edgeTo.size() << " edge entries\n";
+    int entries = 0;
+    for (size_t i = 0; i < cg.edgeTo.size(); i++) entries += cg.edgeTo[i] != cg.edgeFrom[i] || cg.edgeChain[i] >= 0;
+    cout << "compressed  " << cg.keptCount << " nodes, " << entries << " edge entries, "
+         << cg.chainCount() << " chains, built in " << buildMs << " ms\n\n";
+    
+    mt19937 rng(seed);
+    uniform_int_distribution<int> pick(0, graph.nodeCount - 1);
+    vector<pair<int,int>> pairs(numQueries);
+    for (auto& p : pairs) p = {pick(rng), pick(rng)};
+    
+    bool allOk = true;
+    SearchWorkspace ws;
+    for (int type : {Q_CAR, Q_METRO, Q_ALL}) {
+        const QueryParams& qp = queryParams(type);
+        for (int algo = ALGO_DIJKSTRA; algo <= ALGO_BIDIR_ASTAR; algo++) {
+            vector<CostResult> expected, got;
+            long long fullSettled = 0, compressedSettled = 0;
+            t0 = chrono::steady_clock::now();
+            for (auto [s, t] : pairs) {
+                expected.push_back(cheapestRoute(graph, s, t, qp.costPerKm, qp.allowed, ws, algo));
+                fullSettled += expected.back().settled;
+            }
+            double fullMs = msSince(t0);
+            t0 = chrono::steady_clock::now();
+            for (auto [s, t] : pairs) {
+                got.push_back(cg.cheapestRoute(s, t, qp.costPerKm, qp.allowed, ws, algo));
+                compressedSettled += got.back().settled;
+            }
+            double compressedMs = msSince(t0);
+            
+            int mismatches = 0, pathErrors = 0;
+            for (int i = 0; i < numQueries; i++) {
+                const CostResult& a = expected[i];
+                const CostResult& b = got[i];
+                double tol = 1e-9 * max(1.0, a.cost);
+                if ((a.cost < 0) != (b.cost < 0) || fabs(a.cost - b.cost) > tol) mismatches++;
+                else if (b.cost >= 0 && (b.path.front() != pairs[i].first || b.path.back() != pairs[i].second ||
+                                         fabs(routeCost(graph, b, qp.costPerKm, qp.allowed) - b.cost) > tol)) pathErrors++;
+            }
+            allOk = allOk && mismatches == 0 && pathErrors == 0;
+            
+            cout << left << setw(7) << qp.name << setw(9) << algoName(algo) << right << setprecision(3)
+                 << "full " << setw(6) << fullMs / numQueries << " ms " << setprecision(0) << setw(6)
+                 << (double)fullSettled / numQueries << " settled   compressed " << setprecision(3) << setw(6)
+                 << compressedMs / numQueries << " ms " << setprecision(0) << setw(6) << (double)compressedSettled / numQueries
+                 << " settled   " << setprecision(1) << fullMs / compressedMs << "x   "
+                 << mismatches << " cost mismatches, " << pathErrors << " bad paths\n";
+        }
+    }
+    return allOk ? 0 : 1;
+}
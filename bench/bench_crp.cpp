@@ -0,0 +1,113 @@
+// Customizable route planning benchmark: partition once, then customize and query
+// the price tables of the metro, all-modes and deadline problems, checking every
+// answer against Dijkstra on the same random node pairs
+//
+// usage: bench_crp [dataDir] [queries] [seed]
+#include "../common/crp.h"
+#include "../common/query.h"
+#include <chrono>
+#include <random>
+
+double msSince(chrono::steady_clock::time_point t0) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+}
+
+// cost of a returned route, edge by edge
+double routeCost(const Graph& graph, const CostResult& r, const double costPerKm[], const bool allowed[]) {
+    double total = 0;
+    for (size_t k = 0; k + 1 < r.path.size(); k++) {
+        int m = r.modes[k];
+        if (m < 0 || m >= NUM_MODES || !allowed[m]) return -1;
+        double best = INF;
+        for (int e = graph.edgeBegin(r.path[k], m); e < graph.edgeEnd(r.path[k], m); e++) {
+            if (graph.edgeTo[e] == r.path[k + 1]) best = min(best, (double)graph.edgeDist[e]);
+        }
+        if (best >= INF) return -1;
+        total += best * costPerKm[m];
+    }
+    return total;
+}
+
+int main(int argc, char** argv) {
+    string basePath = argc > 1 ? argv[1] : "/media/nym/Nym_s Files/grph-project/";
+    if (!basePath.empty() && basePath.back() != '/') basePath += "/";
+    int numQueries = argc > 2 ? atoi(argv[2]) : 500;
+    int seed = argc > 3 ? atoi(argv[3]) : 1;
+    
+    Graph graph;
+    loadGraph(graph, {
+        {basePath + "Roadmap-Dhaka.csv", 0},
+        {basePath + "Routemap-DhakaMetroRail.csv", 1},
+        {basePath + "Routemap-BikolpoBus.csv", 2},
+        {basePath + "Routemap-UttaraBus.csv", 3}
+    }, basePath + "graph.snap");
+    if (graph.nodeCount == 0) {
+        cout << "No graph data found in " << basePath << "\n";
+        return 1;
+    }
+    
+    CRPPartition part;
+    auto t0 = chrono::steady_clock::now();
+    part.build(graph);
+    cout << graph.nodeCount << " nodes, partition in " << fixed << setprecision(1) << msSince(t0) << " ms\n";
+    for (int l = 0; l < part.levels; l++) {
+        int maxB = 0;
+        for (int c = 0; c < part.cellCount[l]; c++) maxB = max(maxB, part.boundaryCount(l, c));
+        cout << "  level " << l << ": " << part.cellCount[l] << " cells of <= " << part.cellSize[l] << " nodes, "
+             << part.boundaryNodes[l].size() << " boundary nodes (max " << maxB << " per cell), "
+             << part.cliqueSize[l] << " clique entries\n";
+    }
+    cout << "\n";
+    
+    mt19937 rng(seed);
+    uniform_int_distribution<int> pick(0, graph.nodeCount - 1);
+    vector<pair<int,int>> pairs(numQueries);
+    for (auto& p : pairs) p = {pick(rng), pick(rng)};
+    
+    bool allOk = true;
+    SearchWorkspace ws;
+    for (int type : {Q_METRO, Q_ALL, Q_DEADLINE}) {
+        const QueryParams& qp = queryParams(type);
+        CRPMetric metric;
+        t0 = chrono::steady_clock::now();
+        metric.customize(graph, part, qp.costPerKm, qp.allowed);
+        double customizeMs = msSince(t0);
+        
+        double dijkstraMs = 0, crpMs = 0;
+        long long dijkstraSettled = 0, crpSettled = 0;
+        int mismatches = 0, pathErrors = 0;
+        vector<CostResult> expected;
+        t0 = chrono::steady_clock::now();
+        for (auto [s, t] : pairs) {
+            expected.push_back(cheapestRoute(graph, s, t, qp.costPerKm, qp.allowed, ws));
+            dijkstraSettled += expected.back().settled;
+        }
+        dijkstraMs = msSince(t0);
+        vector<CostResult> got;
+        t0 = chrono::steady_clock::now();
+        for (auto [s, t] : pairs) {
+            got.push_back(metric.query(s, t, ws));
+            crpSettled += got.back().settled;
+        }
+        crpMs = msSince(t0);
+        
+        for (int i = 0; i < numQueries; i++) {
+            const CostResult& a = expected[i];
+            const CostResult& b = got[i];
+            double tol = 1e-9 * max(1.0, a.cost);
+            if ((a.cost < 0) != (b.cost < 0) || fabs(a.cost - b.cost) > tol) mismatches++;
+            else if (b.cost >= 0 && (b.path.front() != pairs[i].first || b.path.back() != pairs[i].second ||
+                                     fabs(routeCost(graph, b, qp.costPerKm, qp.allowed) - b.cost) > tol)) pathErrors++;
+        }
+        allOk = allOk && mismatches == 0 && pathErrors == 0;
+        
+        cout << left << setw(9) << qp.name << right << "customize " << setprecision(1) << setw(7) << customizeMs << " ms   "
+             << "dijkstra " << setprecision(3) << setw(7) << dijkstraMs / numQueries << " ms "
+             << setprecision(0) << setw(6) << (double)dijkstraSettled / numQueries << " settled   "
+             << "crp " << setprecision(3) << setw(6) << crpMs / numQueries << " ms "
+             << setprecision(0) << setw(5) << (double)crpSettled / numQueries << " settled   "
+             << setprecision(1) << dijkstraMs / crpMs << "x   "
+             << mismatches << " cost mismatches, " << pathErrors << " bad paths\n";
+    }
+    return allOk ? 0 : 1;
+}
@@ -0,0 +1,111 @@
+// Deadline search benchmark: cheapestWithDeadline with latest-departure pruning against
+// the same search pruned only by the deadline itself, on random transit node pairs with
+// the problem 6 parameters, start and deadline. Pruning must not change an answer: both
+// must find the cost of the cheapest route in time on the Pareto frontier
+//
+// usage: bench_deadline [dataDir] [queries] [seed]
+#include "../common/pareto.h"
+#include "../common/query.h"
+#include <chrono>
+#include <random>
+
+double msSince(chrono::steady_clock::time_point t0) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+}
+
+// cheapestWithDeadline without latestDepartures
+TimeResult deadlineOnly(const Graph& graph, int start, int end, int startMins, int deadlineMins, const QueryParams& p) {
+    vector<int> bestTime(graph.nodeCount, INT_MAX);
+    LabelArena arena;
+    LabelHeap pq(arena, false);
+    pq.push(arena.add(0, startMins, start, -1, 0));
+    int settled = 0;
+    
+    while (!pq.empty()) {
+        int label = pq.pop();
+        double currCost = arena.labels[label].cost;
+        int currTime = arena.labels[label].time;
+        int u = arena.labels[label].node;
+        if (bestTime[u] <= currTime) continue;
+        bestTime[u] = currTime;
+        settled++;
+        if (u == end) return arena.result(label, settled);
+        
+        for (int m = 0; m < NUM_MODES; m++) {
+            if (!p.allowed[m]) continue;
+            for (int i = graph.edgeBegin(u, m); i < graph.edgeEnd(u, m); i++) {
+                int v = graph.edgeTo[i];
+                int arriveTime;
+                if (!edgeTimes(m, graph.edgeDist[i], currTime, p.speeds, p.intervals, p.schedStart, p.schedEnd,
+                               arriveTime)) continue;
+                if (arriveTime > deadlineMins || arriveTime >= bestTime[v]) continue;
+                double newCost = currCost + graph.edgeDist[i] * p.costPerKm[m];
+                pq.push(arena.add(newCost, arriveTime, v, label, m));
+            }
+        }
+    }
+    return {{}, {}, -1, -1, settled};
+}
+
+int main(int argc, char** argv) {
+    string basePath = argc > 1 ? argv[1] : "/media/nym/Nym_s Files/grph-project/";
+    if (!basePath.empty() && basePath.back() != '/') basePath += "/";
+    int numQueries = argc > 2 ? atoi(argv[2]) : 200;
+    int seed = argc > 3 ? atoi(argv[3]) : 1;
+    
+    Graph graph;
+    loadGraph(graph, {
+        {basePath + "Roadmap-Dhaka.csv", 0},
+        {basePath + "Routemap-DhakaMetroRail.csv", 1},
+        {basePath + "Routemap-BikolpoBus.csv", 2},
+        {basePath + "Routemap-UttaraBus.csv", 3}
+    }, basePath + "graph.snap");
+    if (graph.nodeCount == 0) {
+        cout << "No graph data found in " << basePath << "\n";
+        return 1;
+    }
+    
+    vector<int> stops;
+    for (int u = 0; u < graph.nodeCount; u++) {
+        if (graph.nodeModes(u) & ~modeBit(0)) stops.push_back(u);
+    }
+    mt19937 rng(seed);
+    uniform_int_distribution<int> pick(0, (int)stops.size() - 1);
+    vector<pair<int,int>> pairs(numQueries);
+    for (auto& pr : pairs) pr = {stops[pick(rng)], stops[pick(rng)]};
+    
+    const QueryParams& p = queryParams(Q_DEADLINE);
+    bool allOk = true;
+    cout << fixed;
+    for (auto [from, to] : {pair<string,string>{"6:00 PM", "8:30 PM"}, {"6:00 PM", "6:45 PM"}, {"8:00 AM", "9:00 AM"}}) {
+        int startMins = timeToMins(from), deadlineMins = timeToMins(to);
+        double oldMs = 0, newMs = 0;
+        long long oldSettled = 0, newSettled = 0;
+        int found = 0, differ = 0, late = 0;
+        for (auto [s, t] : pairs) {
+            auto t0 = chrono::steady_clock::now();
+            TimeResult a = deadlineOnly(graph, s, t, startMins, deadlineMins, p);
+            oldMs += msSince(t0);
+            t0 = chrono::steady_clock::now();
+            TimeResult b = cheapestWithDeadline(graph, s, t, startMins, deadlineMins, p.costPerKm, p.speeds, p.intervals,
+                                                p.schedStart, p.schedEnd, p.allowed);
+            newMs += msSince(t0);
+            TimeResult c = paretoByDeadline(paretoRoutes(graph, s, t, startMins, p.costPerKm, p.speeds, p.intervals,
+                                                         p.schedStart, p.schedEnd, p.allowed, deadlineMins), deadlineMins);
+            oldSettled += a.settled;
+            newSettled += b.settled;
+            found += b.cost >= 0;
+            if (b.cost >= 0 && b.arrivalTime > deadlineMins) late++;
+            auto same = [](double x, double y) { return (x < 0) == (y < 0) && fabs(x - y) <= 1e-9 * max(1.0, x); };
+            differ += !same(a.cost, b.cost) || !same(b.cost, c.cost);
+        }
+        allOk = allOk && late == 0 && differ == 0;
+        
+        cout << from << " -> " << to << ": deadline only " << setprecision(3) << oldMs / numQueries << " ms, "
+             << setprecision(0) << (double)oldSettled / numQueries << " settled   latest departure " << setprecision(3)
+             << newMs / numQueries << " ms, " << setprecision(0) << (double)newSettled / numQueries << " settled   "
+             << setprecision(1) << (double)oldSettled / max(1LL, newSettled) << "x fewer   " << found << " found, "
+             << differ << " differ, " << late << " late\n";
+    }
+    return allOk ? 0 : 1;
+}
@@ -0,0 +1,91 @@
+// Isochrone benchmark: one isochrone per metro station with the problem 5 parameters,
+// by minutes and by taka, checking sampled nodes inside and outside against
+// fastestRoute / cheapestWithTime to the same node
+//
+// usage: bench_isochrone [dataDir] [minutes] [taka] [checks] [seed]
+#include "../common/isochrone.h"
+#include "../common/query.h"
+#include <chrono>
+#include <random>
+
+double msSince(chrono::steady_clock::time_point t0) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+}
+
+int main(int argc, char** argv) {
+    string basePath = argc > 1 ? argv[1] : "/media/nym/Nym_s Files/grph-project/";
+    if (!basePath.empty() && basePath.back() != '/') basePath += "/";
+    double minutes = argc > 2 ? atof(argv[2]) : 60;
+    double taka = argc > 3 ? atof(argv[3]) : 100;
+    int checks = argc > 4 ? atoi(argv[4]) : 5;
+    int seed = argc > 5 ? atoi(argv[5]) : 1;
+    
+    Graph graph;
+    loadGraph(graph, {
+        {basePath + "Roadmap-Dhaka.csv", 0},
+        {basePath + "Routemap-DhakaMetroRail.csv", 1},
+        {basePath + "Routemap-BikolpoBus.csv", 2},
+        {basePath + "Routemap-UttaraBus.csv", 3}
+    }, basePath + "graph.snap");
+    if (graph.nodeCount == 0) {
+        cout << "No graph data found in " << basePath << "\n";
+        return 1;
+    }
+    
+    vector<int> stations;
+    for (int u = 0; u < graph.nodeCount; u++) {
+        if (graph.nodes[u].isStop && (graph.nodeModes(u) & modeBit(1))) stations.push_back(u);
+    }
+    const QueryParams& p = queryParams(Q_FASTEST);
+    int startMins = timeToMins("9:00 AM");
+    mt19937 rng(seed);
+    uniform_int_distribution<int> anyNode(0, graph.nodeCount - 1);
+    SearchWorkspace ws;
+    bool allOk = true;
+    
+    for (bool byCost : {false, true}) {
+        double budget = byCost ? taka : minutes;
+        double ms = 0, kmlMs = 0;
+        long long reached = 0;
+        int checked = 0, bad = 0;
+        for (int s : stations) {
+            auto t0 = chrono::steady_clock::now();
+            Isochrone iso = isochrone(graph, s, startMins, budget, byCost, p.costPerKm, p.speeds, p.intervals,
+                                      p.schedStart, p.schedEnd, p.allowed, ws);
+            ms += msSince(t0);
+            reached += iso.nodes.size();
+            t0 = chrono::steady_clock::now();
+            saveIsochroneKML(graph, iso, "/tmp/bench_isochrone.kml");
+            kmlMs += msSince(t0);
+            
+            // reached nodes must match the point-to-point search, and a random node
+            // outside must not be reachable within the budget
+            uniform_int_distribution<size_t> inside(0, iso.nodes.size() - 1);
+            vector<char> in(graph.nodeCount, 0);
+            for (int v : iso.nodes) in[v] = 1;
+            for (int c = 0; c < checks; c++) {
+                size_t k = inside(rng);
+                int v = iso.nodes[k], w = anyNode(rng);
+                for (int t : {v, w}) {
+                    TimeResult r = byCost ? cheapestWithTime(graph, s, t, startMins, p.costPerKm, p.speeds, p.intervals,
+                                                             p.schedStart, p.schedEnd, p.allowed)
+                                          : fastestRoute(graph, s, t, startMins, p.costPerKm, p.speeds, p.intervals,
+                                                         p.schedStart, p.schedEnd, p.allowed);
+                    double used = byCost ? r.cost : r.arrivalTime - startMins;
+                    bool within = r.cost >= 0 && used <= budget + 1e-9;
+                    if (t == v) bad += !within || fabs(used - iso.used(k)) > 1e-9 * max(1.0, used);
+                    else if (!in[t]) bad += within;
+                    checked++;
+                }
+            }
+        }
+        allOk = allOk && bad == 0;
+        
+        int n = max((size_t)1, stations.size());
+        cout << stations.size() << " metro stations, " << (byCost ? "Tk " : "") << fixed << setprecision(0) << budget
+             << (byCost ? "" : " min") << " from 9:00 AM: " << reached / n << " nodes reached, " << setprecision(3)
+             << ms / n << " ms search, " << kmlMs / n << " ms KML per isochrone; " << bad << " of " << checked
+             << " checks wrong\n";
+    }
+    return allOk ? 0 : 1;
+}
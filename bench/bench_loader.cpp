@@ -0,0 +1,175 @@
+// Loader benchmark: stream/stod CSV parsing vs the mmap/from_chars path,
+// and std::map vs hashed vs bulk node deduplication
+#include "../common/graph.h"
+#include <chrono>
+
+// the original loaders, kept here as the baseline
+void loadRoadsStream(Graph& graph, string filename) {
+    ifstream file(filename);
+    string line;
+    while (getline(file, line)) {
+        vector<string> parts = parseCSV(line);
+        if (parts.size() < 6) continue;
+        
+        vector<pair<double,double>> coords;
+        for (int i = 1; i < (int)parts.size() - 2; i += 2) {
+            try {
+                double lon = stod(parts[i]);
+                double lat = stod(parts[i+1]);
+                coords.push_back({lat, lon});
+            } catch (...) {
+                break;
+            }
+        }
+        
+        for (int i = 0; i < (int)coords.size() - 1; i++) {
+            int n1 = graph.addNode(coords[i].first, coords[i].second);
+            int n2 = graph.addNode(coords[i+1].first, coords[i+1].second);
+            double dist = haversine(coords[i].first, coords[i].second, coords[i+1].first, coords[i+1].second);
+            graph.addEdge(n1, n2, dist, 0);
+        }
+    }
+}
+
+// tokenize + parse only, without building the graph
+long long parseOnlyStream(string filename) {
+    ifstream file(filename);
+    string line;
+    long long values = 0;
+    while (getline(file, line)) {
+        vector<string> parts = parseCSV(line);
+        for (int i = 1; i < (int)parts.size() - 2; i++) {
+            try {
+                stod(parts[i]);
+                values++;
+            } catch (...) {
+                break;
+            }
+        }
+    }
+    return values;
+}
+
+long long parseOnlyMapped(string filename) {
+    MappedFile file(filename);
+    vector<string_view> parts;
+    long long values = 0;
+    forEachLine(file.view(), [&](string_view line) {
+        splitCSV(line, parts);
+        for (int i = 1; i < (int)parts.size() - 2; i++) {
+            double v;
+            if (!parseDouble(parts[i], v)) break;
+            values++;
+        }
+    });
+    return values;
+}
+
+// every point of every road segment, in the order loadRoads meets them
+vector<pair<double,double>> roadPoints(string filename) {
+    MappedFile file(filename);
+    vector<string_view> parts;
+    vector<pair<double,double>> coords, points;
+    forEachLine(file.view(), [&](string_view line) {
+        splitCSV(line, parts);
+        if (parts.size() < 6) return;
+        parseCoords(parts, coords);
+        if (coords.size() < 2) return;
+        for (size_t i = 0; i + 1 < coords.size(); i++) {
+            points.push_back(coords[i]);
+            points.push_back(coords[i + 1]);
+        }
+    });
+    return points;
+}
+
+// the original std::map dedup: find, then operator[] twice
+int dedupMap(const vector<pair<double,double>>& points) {
+    map<long long, int> nodeMap;
+    int nodeCount = 0;
+    for (auto& p : points) {
+        long long key = makeKey(p.first, p.second);
+        if (nodeMap.find(key) == nodeMap.end()) nodeMap[key] = nodeCount++;
+        volatile int id = nodeMap[key];
+        (void)id;
+    }
+    return nodeCount;
+}
+
+int dedupHash(const vector<pair<double,double>>& points) {
+    NodeIndex index;
+    int nodeCount = 0;
+    for (auto& p : points) {
+        bool inserted;
+        index.findOrInsert(makeKey(p.first, p.second), nodeCount, inserted);
+        if (inserted) nodeCount++;
+    }
+    return nodeCount;
+}
+
+bool sameGraph(Graph& a, Graph& b) {
+    if (a.nodeCount != b.nodeCount) return false;
+    for (int i = 0; i < a.nodeCount; i++) {
+        if (a.nodes[i].lat != b.nodes[i].lat || a.nodes[i].lon != b.nodes[i].lon) return false;
+        if (a.adj[i].size() != b.adj[i].size()) return false;
+        for (size_t j = 0; j < a.adj[i].size(); j++) {
+            Edge& x = a.adj[i][j];
+            Edge& y = b.adj[i][j];
+            if (x.to != y.to || x.dist != y.dist || x.mode != y.mode) return false;
+        }
+    }
+    return true;
+}
+
+template <class Fn>
+double bestSeconds(int reps, Fn fn) {
+    double best = INF;
+    for (int r = 0; r < reps; r++) {
+        auto t0 = chrono::steady_clock::now();
+        fn();
+        auto t1 = chrono::steady_clock::now();
+        best = min(best, chrono::duration<double>(t1 - t0).count());
+    }
+    return best;
+}
+
+void report(string label, double secs, double mb, long long lines) {
+    cout << left << setw(24) << label << fixed << setprecision(2)
+         << setw(10) << secs * 1000 << " ms  "
+         << setw(8) << mb / secs << " MB/s  "
+         << setprecision(0) << lines / secs << " lines/s\n";
+}
+
+int main(int argc, char** argv) {
+    string basePath = argc > 1 ? argv[1] : "/media/nym/Nym_s Files/grph-project/";
+    string filename = basePath + "Roadmap-Dhaka.csv";
+    int reps = argc > 2 ? atoi(argv[2]) : 5;
+    
+    MappedFile probe(filename);
+    if (!probe.data) {
+        cout << "Cannot open " << filename << "\n";
+        return 1;
+    }
+    double mb = probe.size / 1e6;
+    long long lines = count(probe.data, probe.data + probe.size, '\n');
+    cout << filename << ": " << fixed << setprecision(2) << mb << " MB, " << lines << " lines\n\n";
+    
+    Graph oldGraph, newGraph;
+    loadRoadsStream(oldGraph, filename);
+    loadRoads(newGraph, filename);
+    cout << "Graphs identical: " << (sameGraph(oldGraph, newGraph) ? "yes" : "NO") << "\n\n";
+    
+    report("parse stream+stod", bestSeconds(reps, [&] { parseOnlyStream(filename); }), mb, lines);
+    report("parse mmap+from_chars", bestSeconds(reps, [&] { parseOnlyMapped(filename); }), mb, lines);
+    report("load stream+stod", bestSeconds(reps, [&] { Graph g; loadRoadsStream(g, filename); }), mb, lines);
+    report("load mmap+from_chars", bestSeconds(reps, [&] { Graph g; loadRoads(g, filename); }), mb, lines);
+    
+    vector<pair<double,double>> points = roadPoints(filename);
+    cout << "\nNode dedup over " << points.size() << " segment endpoints (" << dedupHash(points) << " distinct)\n";
+    report("dedup std::map", bestSeconds(reps, [&] { dedupMap(points); }), mb, lines);
+    report("dedup NodeIndex", bestSeconds(reps, [&] { dedupHash(points); }), mb, lines);
+    report("dedup Graph::addNode", bestSeconds(reps, [&] { Graph g; for (auto& p : points) g.addNode(p.first, p.second); }), mb, lines);
+    report("dedup addNodesBulk", bestSeconds(reps, [&] { Graph g; g.addNodesBulk(points); }), mb, lines);
+    
+    return 0;
+}
@@ -0,0 +1,113 @@
+// Matrix benchmark: throughput of costMatrix and chMatrix against one cheapestRoute or
+// hierarchy query per pair, on every metro station x every bus stop (costs of the all
+// query type) and on random road nodes (car km), checking that the entries agree
+//
+// usage: bench_matrix [dataDir] [carNodes] [pairwiseSample] [seed]
+#include "../common/matrix.h"
+#include "../common/query.h"
+#include <chrono>
+#include <random>
+
+double msSince(chrono::steady_clock::time_point t0) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+}
+
+void report(string label, double ms, size_t entries) {
+    cout << "  " << left << setw(28) << label << right << fixed << setprecision(1) << setw(9) << ms << " ms "
+         << setprecision(0) << setw(12) << entries / ms * 1000 << " entries/s\n";
+}
+
+// entries of b that differ from a, by the relative tolerance of the search costs
+int mismatches(const CostMatrix& a, const CostMatrix& b) {
+    int bad = 0;
+    for (size_t k = 0; k < a.cost.size(); k++) {
+        if (fabs(a.cost[k] - b.cost[k]) > 1e-9 * max(1.0, fabs(a.cost[k]))) bad++;
+    }
+    return bad;
+}
+
+int main(int argc, char** argv) {
+    string basePath = argc > 1 ? argv[1] : "/media/nym/Nym_s Files/grph-project/";
+    if (!basePath.empty() && basePath.back() != '/') basePath += "/";
+    int carNodes = argc > 2 ? atoi(argv[2]) : 200;
+    int sample = argc > 3 ? atoi(argv[3]) : 500;
+    int seed = argc > 4 ? atoi(argv[4]) : 1;
+    
+    Graph graph;
+    loadGraph(graph, {
+        {basePath + "Roadmap-Dhaka.csv", 0},
+        {basePath + "Routemap-DhakaMetroRail.csv", 1},
+        {basePath + "Routemap-BikolpoBus.csv", 2},
+        {basePath + "Routemap-UttaraBus.csv", 3}
+    }, basePath + "graph.snap");
+    if (graph.nodeCount == 0) {
+        cout << "No graph data found in " << basePath << "\n";
+        return 1;
+    }
+    mt19937 rng(seed);
+    bool allOk = true;
+    SearchWorkspace ws;
+    
+    // pairwise: time one query per pair on a sample of the entries and scale up
+    auto pairwise = [&](const CostMatrix& ref, auto query) {
+        uniform_int_distribution<size_t> pick(0, ref.cost.size() - 1);
+        int n = min((size_t)sample, ref.cost.size()), bad = 0;
+        auto t0 = chrono::steady_clock::now();
+        for (int k = 0; k < n; k++) {
+            size_t e = pick(rng);
+            double c = query(ref.sources[e / ref.cols()], ref.targets[e % ref.cols()]);
+            if (fabs(c - ref.cost[e]) > 1e-9 * max(1.0, fabs(c))) bad++;
+        }
+        report("pairwise (sampled)", msSince(t0) * ref.cost.size() / n, ref.cost.size());
+        return bad;
+    };
+    
+    // every metro station x every bus stop, costs of the all query type
+    const QueryParams& p = queryParams(Q_ALL);
+    vector<int> stations, busStops;
+    for (int u = 0; u < graph.nodeCount; u++) {
+        if (!graph.nodes[u].isStop) continue;
+        int mask = graph.nodeModes(u);
+        if (mask & modeBit(1)) stations.push_back(u);
+        if (mask & (modeBit(2) | modeBit(3))) busStops.push_back(u);
+    }
+    cout << stations.size() << " metro stations x " << busStops.size() << " bus stops, all costs\n";
+    auto t0 = chrono::steady_clock::now();
+    CostMatrix one = costMatrix(graph, stations, busStops, p.costPerKm, p.allowed, 1);
+    report("costMatrix, 1 thread", msSince(t0), one.cost.size());
+    t0 = chrono::steady_clock::now();
+    CostMatrix many = costMatrix(graph, stations, busStops, p.costPerKm, p.allowed, 0);
+    report("costMatrix, all threads", msSince(t0), many.cost.size());
+    int bad = mismatches(one, many) + pairwise(one, [&](int s, int t) {
+        return cheapestRoute(graph, s, t, p.costPerKm, p.allowed, ws).cost;
+    });
+    cout << "  " << bad << " mismatches\n\n";
+    allOk = allOk && bad == 0;
+    
+    // random road nodes both ways, car km
+    ContractionHierarchy ch;
+    loadOrBuildCH(ch, graph, basePath + "graph.ch");
+    vector<int> road;
+    for (int u = 0; u < graph.nodeCount; u++) {
+        if (graph.nodeModes(u) & modeBit(0)) road.push_back(u);
+    }
+    uniform_int_distribution<int> pickRoad(0, (int)road.size() - 1);
+    vector<int> nodes(carNodes);
+    for (int& v : nodes) v = road[pickRoad(rng)];
+    cout << carNodes << " x " << carNodes << " random road nodes, car km\n";
+    t0 = chrono::steady_clock::now();
+    CostMatrix dij = costMatrix(graph, nodes, nodes, CAR_PER_KM, CAR_ONLY, 1);
+    report("costMatrix, 1 thread", msSince(t0), dij.cost.size());
+    t0 = chrono::steady_clock::now();
+    CostMatrix buckets = chMatrix(ch, nodes, nodes, 1);
+    report("chMatrix, 1 thread", msSince(t0), buckets.cost.size());
+    t0 = chrono::steady_clock::now();
+    CostMatrix bucketsMany = chMatrix(ch, nodes, nodes, 0);
+    report("chMatrix, all threads", msSince(t0), bucketsMany.cost.size());
+    bad = mismatches(dij, buckets) + mismatches(dij, bucketsMany) + pairwise(dij, [&](int s, int t) {
+        return ch.query(s, t, ws).cost;
+    });
+    cout << "  " << bad << " mismatches\n";
+    allOk = allOk && bad == 0;
+    return allOk ? 0 : 1;
+}
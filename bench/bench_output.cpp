@@ -0,0 +1,139 @@
+// Output benchmark: car routes between random nodes written as one KML file each with
+// stream formatting (saveKML as it was), with saveKML on RouteWriter, and as one KML
+// and one GeoJSON document holding all of them, checking that saveKML writes the same
+// bytes as before; then the segment distances of printRoute from haversine against
+// the edge lengths the search used
+//
+// usage: bench_output [dataDir] [routes] [seed]
+#include "../common/ch.h"
+#include <chrono>
+#include <random>
+
+double msSince(chrono::steady_clock::time_point t0) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+}
+
+// saveKML before RouteWriter
+void streamKML(const Graph& graph, const vector<int>& path, string filename) {
+    ofstream file(filename);
+    file << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+    file << "<kml xmlns=\"http://earth.google.com/kml/2.1\">\n";
+    file << "<Document>\n";
+    file << "<Placemark>\n";
+    file << "<name>" << filename << "</name>\n";
+    file << "<LineString>\n";
+    file << "<tessellate>1</tessellate>\n";
+    file << "<coordinates>\n";
+    for (int id : path) {
+        file << fixed << setprecision(6) << graph.nodes[id].lon << "," << graph.nodes[id].lat << ",0\n";
+    }
+    file << "</coordinates>\n";
+    file << "</LineString>\n";
+    file << "</Placemark>\n";
+    file << "</Document>\n";
+    file << "</kml>\n";
+    file.close();
+}
+
+string readFile(const string& filename) {
+    ifstream in(filename, ios::binary);
+    stringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+int main(int argc, char** argv) {
+    string basePath = argc > 1 ? argv[1] : "/media/nym/Nym_s Files/grph-project/";
+    if (!basePath.empty() && basePath.back() != '/') basePath += "/";
+    int numRoutes = argc > 2 ? atoi(argv[2]) : 2000;
+    int seed = argc > 3 ? atoi(argv[3]) : 1;
+    
+    Graph graph;
+    loadGraph(graph, {
+        {basePath + "Roadmap-Dhaka.csv", 0},
+        {basePath + "Routemap-DhakaMetroRail.csv", 1},
+        {basePath + "Routemap-BikolpoBus.csv", 2},
+        {basePath + "Routemap-UttaraBus.csv", 3}
+    }, basePath + "graph.snap");
+    if (graph.nodeCount == 0) {
+        cout << "No graph data found in " << basePath << "\n";
+        return 1;
+    }
+    ContractionHierarchy ch;
+    loadOrBuildCH(ch, graph, basePath + "graph.ch");
+    
+    mt19937 rng(seed);
+    uniform_int_distribution<int> pick(0, graph.nodeCount - 1);
+    SearchWorkspace ws;
+    vector<CostResult> routes;
+    long long points = 0;
+    while ((int)routes.size() < numRoutes) {
+        CostResult r = ch.query(pick(rng), pick(rng), ws);
+        if (r.cost < 0 || r.path.size() < 2) continue;
+        points += r.path.size();
+        routes.push_back(move(r));
+    }
+    cout << numRoutes << " car routes, " << points / numRoutes << " points each on average\n" << fixed;
+    
+    string dir = "/tmp/bench_output_";
+    auto report = [&](string label, double ms, string file) {
+        double mb = 0;
+        if (!file.empty()) mb = readFile(file).size() / 1048576.0;
+        cout << "  " << left << setw(28) << label << right << setprecision(1) << setw(8) << ms * 1000 / numRoutes
+             << " us per route";
+        if (mb > 0) cout << ", " << setprecision(1) << mb << " MB at " << mb / (ms / 1000) << " MB/s";
+        cout << "\n";
+    };
+    
+    auto t0 = chrono::steady_clock::now();
+    for (int i = 0; i < numRoutes; i++) streamKML(graph, routes[i].path, dir + "old.kml");
+    report("saveKML, stream formatting", msSince(t0), "");
+    t0 = chrono::steady_clock::now();
+    for (int i = 0; i < numRoutes; i++) saveKML(graph, routes[i].path, dir + "new.kml");
+    report("saveKML, RouteWriter", msSince(t0), "");
+    
+    t0 = chrono::steady_clock::now();
+    {
+        RouteWriter doc(dir + "all.kml", FORMAT_KML, "bench");
+        for (int i = 0; i < numRoutes; i++) doc.addRoute(graph, routes[i].path, "route " + to_string(i));
+    }
+    report("one KML document", msSince(t0), dir + "all.kml");
+    t0 = chrono::steady_clock::now();
+    {
+        RouteWriter doc(dir + "all.geojson", FORMAT_GEOJSON);
+        for (int i = 0; i < numRoutes; i++) doc.addRoute(graph, routes[i].path, "route " + to_string(i));
+    }
+    report("one GeoJSON document", msSince(t0), dir + "all.geojson");
+    
+    // saveKML must write what it always did; both name the file the same way
+    int differ = 0, checked = min(numRoutes, 200);
+    for (int i = 0; i < checked; i++) {
+        streamKML(graph, routes[i].path, dir + "check.kml");
+        string before = readFile(dir + "check.kml");
+        saveKML(graph, routes[i].path, dir + "check.kml");
+        differ += readFile(dir + "check.kml") != before;
+    }
+    cout << "  saveKML output: " << differ << " of " << checked << " files differ\n";
+    
+    // printRoute's segment lengths: straight lines between the nodes, as it used to
+    // measure them, against the edges the search took
+    double straight = 0, edges = 0, sink = 0, worst = 0;
+    for (int pass = 0; pass < 2; pass++) {
+        t0 = chrono::steady_clock::now();
+        for (const CostResult& r : routes) {
+            double total = 0;
+            for (size_t k = 0; k + 1 < r.path.size(); k++) {
+                int u = r.path[k], v = r.path[k + 1];
+                total += pass == 0 ? haversine(graph.nodes[u].lat, graph.nodes[u].lon, graph.nodes[v].lat, graph.nodes[v].lon)
+                                   : stepLength(graph, u, v, r.modes[k]);
+            }
+            if (pass == 1) worst = max(worst, fabs(total - r.cost));
+            sink += total;
+        }
+        (pass == 0 ? straight : edges) = msSince(t0) * 1e6 / (points - numRoutes);
+    }
+    cout << "  segment lengths: " << setprecision(1) << straight << " ns per step from haversine, " << edges
+         << " ns from the edges; largest gap to the search's km " << scientific << setprecision(1) << worst
+         << (sink < 0 ? "" : "\n");
+    return differ == 0 && worst < 1e-9 ? 0 : 1;
+}
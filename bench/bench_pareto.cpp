@@ -0,0 +1,99 @@
+// Pareto search benchmark: for the parameters of problems 4, 5 and 6, one frontier
+// search against the single-criterion search of that problem on random node pairs,
+// checking that the answer read off the frontier is never worse
+//
+// usage: bench_pareto [dataDir] [queries] [seed]
+#include "../common/pareto.h"
+#include "../common/query.h"
+#include <chrono>
+#include <random>
+
+double msSince(chrono::steady_clock::time_point t0) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+}
+
+int main(int argc, char** argv) {
+    string basePath = argc > 1 ? argv[1] : "/media/nym/Nym_s Files/grph-project/";
+    if (!basePath.empty() && basePath.back() != '/') basePath += "/";
+    int numQueries = argc > 2 ? atoi(argv[2]) : 100;
+    int seed = argc > 3 ? atoi(argv[3]) : 1;
+    
+    Graph graph;
+    loadGraph(graph, {
+        {basePath + "Roadmap-Dhaka.csv", 0},
+        {basePath + "Routemap-DhakaMetroRail.csv", 1},
+        {basePath + "Routemap-BikolpoBus.csv", 2},
+        {basePath + "Routemap-UttaraBus.csv", 3}
+    }, basePath + "graph.snap");
+    if (graph.nodeCount == 0) {
+        cout << "No graph data found in " << basePath << "\n";
+        return 1;
+    }
+    
+    // pairs of transit nodes so the frontier has transit routes on it
+    vector<int> stops;
+    for (int u = 0; u < graph.nodeCount; u++) {
+        if (graph.nodeModes(u) & ~modeBit(0)) stops.push_back(u);
+    }
+    mt19937 rng(seed);
+    uniform_int_distribution<int> pick(0, (int)stops.size() - 1);
+    uniform_int_distribution<int> minute(timeToMins("6:00 AM"), timeToMins("9:00 PM"));
+    uniform_int_distribution<int> allowance(30, 180);
+    vector<tuple<int,int,int,int>> work(numQueries);
+    for (auto& w : work) {
+        int start = minute(rng);
+        w = {stops[pick(rng)], stops[pick(rng)], start, start + allowance(rng)};
+    }
+    
+    bool allOk = true;
+    cout << fixed;
+    for (int type : {Q_TIMED, Q_FASTEST, Q_DEADLINE}) {
+        const QueryParams& p = queryParams(type);
+        double oldMs = 0, paretoMs = 0;
+        long long frontier = 0, labels = 0;
+        int found = 0, better = 0, worse = 0;
+        for (auto [s, t, start, deadline] : work) {
+            auto t0 = chrono::steady_clock::now();
+            TimeResult a;
+            if (type == Q_TIMED) {
+                a = cheapestWithTime(graph, s, t, start, p.costPerKm, p.speeds, p.intervals, p.schedStart, p.schedEnd, p.allowed);
+            } else if (type == Q_FASTEST) {
+                a = fastestRoute(graph, s, t, start, p.costPerKm, p.speeds, p.intervals, p.schedStart, p.schedEnd, p.allowed);
+            } else {
+                a = cheapestWithDeadline(graph, s, t, start, deadline, p.costPerKm, p.speeds, p.intervals, p.schedStart,
+                                         p.schedEnd, p.allowed);
+            }
+            oldMs += msSince(t0);
+            
+            t0 = chrono::steady_clock::now();
+            ParetoResult pr = paretoRoutes(graph, s, t, start, p.costPerKm, p.speeds, p.intervals, p.schedStart,
+                                           p.schedEnd, p.allowed, type == Q_DEADLINE ? deadline : INT_MAX);
+            paretoMs += msSince(t0);
+            frontier += pr.frontier.size();
+            labels += pr.labels;
+            
+            TimeResult b = type == Q_TIMED ? paretoCheapest(pr) : type == Q_FASTEST ? paretoFastest(pr)
+                                                                                  : paretoByDeadline(pr, deadline);
+            if (a.cost < 0 && b.cost < 0) continue;
+            found++;
+            // rank by the problem's criterion, the other one breaking ties
+            double tol = 1e-9 * max(1.0, a.cost);
+            auto key = [&](const TimeResult& r) {
+                if (r.cost < 0) return make_pair(INF, INF);
+                if (type == Q_FASTEST) return make_pair((double)r.arrivalTime, r.cost);
+                return make_pair(r.cost, (double)r.arrivalTime);
+            };
+            auto ka = key(a), kb = key(b);
+            if (kb.first > ka.first + tol || (fabs(kb.first - ka.first) <= tol && kb.second > ka.second + tol)) worse++;
+            else if (kb.first < ka.first - tol || kb.second < ka.second - tol) better++;
+        }
+        allOk = allOk && worse == 0;
+        
+        cout << left << setw(9) << p.name << right << "single " << setprecision(3) << setw(7) << oldMs / numQueries
+             << " ms   pareto " << setw(7) << paretoMs / numQueries << " ms " << setprecision(1) << setw(5)
+             << (double)frontier / numQueries << " on frontier " << setprecision(0) << setw(7)
+             << (double)labels / numQueries << " labels   " << found << " found, " << better << " better, " << worse
+             << " worse\n";
+    }
+    return allOk ? 0 : 1;
+}
@@ -0,0 +1,156 @@
+// Priority queue benchmark: the three queues of heap.h on a synthetic Dijkstra-like
+// workload (pop the minimum, push a few larger keys), then end to end on the searches
+// that take a SearchWorkspace, checking that every queue gives the same costs, also when
+// one workspace runs all of them in turn (node and node-mode state counts mixed)
+//
+// usage: bench_queue [dataDir] [queries] [seed]
+#include "../common/isochrone.h"
+#include "../common/query.h"
+#include "../common/timedep.h"
+#include <chrono>
+#include <functional>
+#include <random>
+
+double msSince(chrono::steady_clock::time_point t0) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+}
+
+const int QUEUES[] = {QUEUE_BINARY, QUEUE_QUAD, QUEUE_RADIX};
+
+// ns per push + pop: every pop pushes `fanout` keys a random step above it until `pops`
+// pops are done; integer steps of 1..30 like edge minutes, or fractional ones like costs
+double holdBenchmark(int queue, int pops, int fanout, bool integer, int seed) {
+    mt19937 rng(seed);
+    uniform_int_distribution<int> minutes(1, 30);
+    uniform_real_distribution<double> cost(0, 30);
+    SearchWorkspace ws;
+    ws.queue = queue;
+    int n = pops * fanout + 1; // every push a new node, as the quad heap holds each node once
+    ws.reset(n);
+    int next = 0;
+    ws.push(0, next++);
+    
+    auto t0 = chrono::steady_clock::now();
+    long long ops = 1;
+    double sink = 0;
+    for (int i = 0; i < pops && !ws.empty(); i++) {
+        auto [k, u] = ws.pop();
+        sink += u;
+        for (int f = 0; f < fanout; f++) {
+            ws.push(k + (integer ? minutes(rng) : cost(rng)), next++);
+            ops++;
+        }
+        ops++;
+    }
+    double ns = msSince(t0) * 1e6 / ops;
+    return sink < 0 ? 0 : ns;
+}
+
+int main(int argc, char** argv) {
+    string basePath = argc > 1 ? argv[1] : "/media/nym/Nym_s Files/grph-project/";
+    if (!basePath.empty() && basePath.back() != '/') basePath += "/";
+    int numQueries = argc > 2 ? atoi(argv[2]) : 200;
+    int seed = argc > 3 ? atoi(argv[3]) : 1;
+    
+    cout << "queue operations (ns per push or pop, 1M pops)\n";
+    cout << fixed << setprecision(1);
+    for (bool integer : {true, false}) {
+        for (int fanout : {1, 3}) {
+            cout << "  " << (integer ? "minute keys" : "cost keys  ") << ", " << fanout << " push per pop:";
+            for (int q : QUEUES) cout << "   " << queueName(q) << " " << holdBenchmark(q, 1000000, fanout, integer, seed);
+            cout << "\n";
+        }
+    }
+    
+    Graph graph;
+    loadGraph(graph, {
+        {basePath + "Roadmap-Dhaka.csv", 0},
+        {basePath + "Routemap-DhakaMetroRail.csv", 1},
+        {basePath + "Routemap-BikolpoBus.csv", 2},
+        {basePath + "Routemap-UttaraBus.csv", 3}
+    }, basePath + "graph.snap");
+    if (graph.nodeCount == 0) {
+        cout << "No graph data found in " << basePath << "\n";
+        return 1;
+    }
+    ContractionHierarchy ch;
+    loadOrBuildCH(ch, graph, basePath + "graph.ch");
+    
+    mt19937 rng(seed);
+    uniform_int_distribution<int> pick(0, graph.nodeCount - 1);
+    uniform_int_distribution<int> minute(timeToMins("6:00 AM"), timeToMins("9:00 PM"));
+    vector<tuple<int,int,int>> work(numQueries);
+    for (auto& w : work) w = {pick(rng), pick(rng), minute(rng)};
+    const QueryParams& all = queryParams(Q_ALL);
+    const QueryParams& fast = queryParams(Q_FASTEST);
+    
+    // one number per query from each search, as the search computes it
+    vector<pair<string, function<double(int, int, int, SearchWorkspace&)>>> searches = {
+        {"dijkstra, all modes", [&](int s, int t, int, SearchWorkspace& ws) {
+            return cheapestRoute(graph, s, t, all.costPerKm, all.allowed, ws).cost;
+        }},
+        {"astar, all modes", [&](int s, int t, int, SearchWorkspace& ws) {
+            return cheapestRoute(graph, s, t, all.costPerKm, all.allowed, ws, ALGO_ASTAR).cost;
+        }},
+        {"bidir, all modes", [&](int s, int t, int, SearchWorkspace& ws) {
+            return cheapestRoute(graph, s, t, all.costPerKm, all.allowed, ws, ALGO_BIDIR_ASTAR).cost;
+        }},
+        {"ch, car", [&](int s, int t, int, SearchWorkspace& ws) { return ch.query(s, t, ws).cost; }},
+        {"earliest arrival", [&](int s, int t, int start, SearchWorkspace& ws) {
+            return earliestArrival(graph, s, t, start, fast.costPerKm, fast.speeds, fast.intervals, fast.schedStart,
+                                   fast.schedEnd, fast.allowed, ws).arrivalTime;
+        }},
+        {"isochrone, 60 min", [&](int s, int, int start, SearchWorkspace& ws) {
+            Isochrone iso = isochrone(graph, s, start, 60, false, fast.costPerKm, fast.speeds, fast.intervals,
+                                      fast.schedStart, fast.schedEnd, fast.allowed, ws);
+            double total = 0;
+            for (size_t k = 0; k < iso.nodes.size(); k++) total += iso.used(k);
+            return total;
+        }},
+    };
+    
+    bool allOk = true;
+    vector<vector<double>> expected(searches.size());
+    cout << "\n" << numQueries << " random queries, ms per query\n";
+    for (size_t k = 0; k < searches.size(); k++) {
+        auto& [name, search] = searches[k];
+        cout << "  " << left << setw(20) << name << right;
+        for (int q : QUEUES) {
+            SearchWorkspace ws;
+            ws.queue = q;
+            int bad = 0;
+            auto t0 = chrono::steady_clock::now();
+            for (size_t i = 0; i < work.size(); i++) {
+                auto [s, t, start] = work[i];
+                double got = search(s, t, start, ws);
+                if (q == QUEUE_BINARY) expected[k].push_back(got);
+                else bad += fabs(got - expected[k][i]) > 1e-9 * max(1.0, fabs(got));
+            }
+            cout << "   " << queueName(q) << " " << setprecision(3) << msSince(t0) / numQueries;
+            if (bad) cout << " (" << bad << " differ)";
+            allOk = allOk && bad == 0;
+        }
+        cout << "\n";
+    }
+    
+    // every search in turn on one workspace per queue
+    cout << "  " << left << setw(20) << "mixed, one workspace" << right;
+    for (int q : QUEUES) {
+        SearchWorkspace ws;
+        ws.queue = q;
+        int bad = 0;
+        auto t0 = chrono::steady_clock::now();
+        for (size_t i = 0; i < work.size(); i++) {
+            auto [s, t, start] = work[i];
+            for (size_t k = 0; k < searches.size(); k++) {
+                double got = searches[k].second(s, t, start, ws);
+                bad += fabs(got - expected[k][i]) > 1e-9 * max(1.0, fabs(got));
+            }
+        }
+        cout << "   " << queueName(q) << " " << setprecision(3) << msSince(t0) / numQueries;
+        if (bad) cout << " (" << bad << " differ)";
+        allOk = allOk && bad == 0;
+    }
+    cout << "\n";
+    return allOk ? 0 : 1;
+}
@@ -0,0 +1,120 @@
+// RAPTOR benchmark: build the transit routes once, then answer random journeys with the
+// problem 5 parameters, checking every Pareto journey edge by edge and comparing the
+// earliest one with earliestArrival, which can only be as early or earlier
+//
+// usage: bench_raptor [dataDir] [queries] [seed]
+#include "../common/raptor.h"
+#include "../common/query.h"
+#include <chrono>
+#include <random>
+
+double msSince(chrono::steady_clock::time_point t0) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+}
+
+// cost of a journey edge by edge, -1 if it uses an edge the graph does not have
+double journeyCost(const Graph& graph, const TimeDepResult& r, const double costPerKm[]) {
+    double total = 0;
+    for (size_t k = 0; k + 1 < r.path.size(); k++) {
+        int m = r.modes[k];
+        double best = INF;
+        for (int e = graph.edgeBegin(r.path[k], m); e < graph.edgeEnd(r.path[k], m); e++) {
+            if (graph.edgeTo[e] == r.path[k + 1]) best = min(best, (double)graph.edgeDist[e]);
+        }
+        if (best >= INF) return -1;
+        total += best * costPerKm[m];
+    }
+    return total;
+}
+
+int main(int argc, char** argv) {
+    string basePath = argc > 1 ? argv[1] : "/media/nym/Nym_s Files/grph-project/";
+    if (!basePath.empty() && basePath.back() != '/') basePath += "/";
+    int numQueries = argc > 2 ? atoi(argv[2]) : 200;
+    int seed = argc > 3 ? atoi(argv[3]) : 1;
+    
+    Graph graph;
+    loadGraph(graph, {
+        {basePath + "Roadmap-Dhaka.csv", 0},
+        {basePath + "Routemap-DhakaMetroRail.csv", 1},
+        {basePath + "Routemap-BikolpoBus.csv", 2},
+        {basePath + "Routemap-UttaraBus.csv", 3}
+    }, basePath + "graph.snap");
+    if (graph.nodeCount == 0) {
+        cout << "No graph data found in " << basePath << "\n";
+        return 1;
+    }
+    
+    TransitNetwork net;
+    auto t0 = chrono::steady_clock::now();
+    net.build(graph);
+    cout << net.stopCount() << " stops, " << net.routeCount() << " routes (" << net.routeStops.size()
+         << " route stops), built in " << fixed << setprecision(1) << msSince(t0) << " ms\n\n";
+    
+    // pairs of transit nodes so most journeys have a reason to board
+    vector<int> stops;
+    for (int u = 0; u < graph.nodeCount; u++) {
+        if (graph.nodeModes(u) & ~modeBit(0)) stops.push_back(u);
+    }
+    mt19937 rng(seed);
+    uniform_int_distribution<int> pick(0, (int)stops.size() - 1);
+    uniform_int_distribution<int> minute(timeToMins("6:00 AM"), timeToMins("9:00 PM"));
+    vector<tuple<int,int,int>> work(numQueries);
+    for (auto& w : work) w = {stops[pick(rng)], stops[pick(rng)], minute(rng)};
+    
+    bool allOk = true;
+    SearchWorkspace ws;
+    for (int variant = 0; variant < 2; variant++) {
+        // problem 5 parameters, then transit faster than driving so journeys board and ride
+        QueryParams p = queryParams(Q_FASTEST);
+        if (variant == 1) {
+            p.speeds[1] = 40;
+            p.speeds[2] = p.speeds[3] = 25;
+        }
+        
+        double eaMs = 0, raptorMs = 0, gap = 0;
+        long long journeys = 0, labels = 0, boarded = 0;
+        int found = 0, equal = 0, earlier = 0, badPaths = 0;
+        for (auto [s, t, start] : work) {
+            t0 = chrono::steady_clock::now();
+            TimeDepResult a = earliestArrival(graph, s, t, start, p.costPerKm, p.speeds, p.intervals, p.schedStart,
+                                              p.schedEnd, p.allowed, ws);
+            eaMs += msSince(t0);
+            
+            t0 = chrono::steady_clock::now();
+            vector<TimeDepResult> set = transitJourneys(graph, net, s, t, start, p.costPerKm, p.speeds, p.intervals,
+                                                        p.schedStart, p.schedEnd, p.allowed, ws);
+            raptorMs += msSince(t0);
+            
+            for (const TimeDepResult& r : set) {
+                bool ok = r.path.front() == s && r.path.back() == t && r.modes.size() + 1 == r.path.size() &&
+                          r.times.size() == r.path.size() && fabs(r.times.back() - r.arrivalTime) < 1e-6 &&
+                          fabs(journeyCost(graph, r, p.costPerKm) - r.cost) < 1e-6 * max(1.0, r.cost);
+                for (size_t k = 1; k < r.times.size(); k++) ok = ok && r.times[k] >= r.times[k - 1] - 1e-9;
+                if (!ok) badPaths++;
+            }
+            if (a.cost < 0 || set.empty()) continue;
+            found++;
+            journeys += set.size();
+            labels += set[0].settled;
+            boarded += set[0].boardings;
+            double diff = set[0].arrivalTime - a.arrivalTime;
+            if (diff < -1e-6) earlier++;
+            else if (diff < 1e-6) equal++;
+            gap += diff;
+        }
+        allOk = allOk && earlier == 0 && badPaths == 0;
+        
+        cout << (variant == 0 ? "problem 5 parameters" : "metro 40 km/h, buses 25 km/h") << ": " << found << " of "
+             << numQueries << " queries with a route\n";
+        cout << setprecision(3);
+        cout << "earliestArrival  " << eaMs / numQueries << " ms/query\n";
+        cout << "transitJourneys  " << raptorMs / numQueries << " ms/query, " << setprecision(0)
+             << (double)labels / max(1, found) << " labels, " << setprecision(2)
+             << (double)journeys / max(1, found) << " Pareto journeys, " << (double)boarded / max(1, found)
+             << " boardings on the earliest\n";
+        cout << "earliest journey same arrival on " << equal << ", later by " << gap / max(1, found)
+             << " min on average; " << earlier << " earlier than earliestArrival, " << badPaths << " bad journeys\n\n";
+    }
+    return allOk ? 0 : 1;
+}
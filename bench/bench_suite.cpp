@@ -0,0 +1,360 @@
+// Routing benchmark suite: seeded origin-destination workloads over the Dhaka graph,
+// answered by every query type and search variant, with latency percentiles, settled
+// nodes, heap pushes and peak memory written as JSON for comparing builds
+//
+// usage: bench_suite [--json FILE] [--compare OLD.json] [--per-bucket N] [--seed S] [--all-queues] [dataDir]
+//   Two workloads: "random" pairs of uniformly drawn nodes, and "stops" pairs of points
+//   within 300 m of transit stops, popular stops drawn more often (weight 1 / rank).
+//   Each is split by straight-line distance into short (< 3 km), medium (3-8 km) and
+//   long (>= 8 km) buckets of N queries (default 40), with start times between 6:00 AM
+//   and 9:00 PM and deadlines 30 min + 10 min per km later.
+//   Every query goes through answerQuery, so the latency includes snapping. Variants of
+//   one query type must agree with the first one listed on every answer (cost, or
+//   arrival for fastest / earliest / transit); disagreements are counted as mismatches
+//   and make the exit status 1. The timed label search keeps one label per node and may
+//   miss the cheapest route, so it is checked against the Pareto search only for never
+//   doing better, and the answers it does worse on are counted apart.
+//   --json writes the results there (one result per line); --compare reads an earlier
+//   JSON file and prints the p50 / p99 change of every result present in both.
+//   --all-queues also runs the node searches with the quad and radix queues.
+#include "../common/query.h"
+#include "../common/snapshot.h"
+#include <chrono>
+#include <random>
+#include <sys/resource.h>
+
+double msSince(chrono::steady_clock::time_point t0) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+}
+
+// peak resident memory of the process so far
+long peakRssKB() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+const char* WORKLOADS[] = {"random", "stops"};
+const char* BUCKETS[] = {"short", "medium", "long"};
+const double BUCKET_KM[] = {0, 3, 8, INF};
+
+struct Variant {
+    string name;
+    int type;
+    int algo = ALGO_DIJKSTRA;
+    bool ch = false;
+    bool compressed = false;
+    bool crp = false;
+    bool pareto = false;
+    int queue = QUEUE_BINARY;
+    bool exact = true; // false: may answer worse than the first variant of its type
+};
+
+struct Row {
+    string variant, workload, bucket;
+    int queries = 0, found = 0, mismatches = 0, worse = 0;
+    double p50 = 0, p95 = 0, p99 = 0, mean = 0, settled = 0, pushes = 0;
+    long peakKB = 0;
+};
+
+// nearest-rank percentile of sorted values
+double percentile(const vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    size_t rank = (size_t)ceil(p / 100 * sorted.size());
+    return sorted[min(sorted.size(), max((size_t)1, rank)) - 1];
+}
+
+// endpoints of one workload bucket, drawn until the bucket is full or too many tries fail
+vector<pair<pair<double,double>, pair<double,double>>> makePairs(const Graph& graph, bool nearStops, int bucket,
+                                                                 int count, mt19937& rng) {
+    vector<int> stops;
+    for (int u = 0; u < graph.nodeCount; u++) {
+        if (graph.nodes[u].isStop) stops.push_back(u);
+    }
+    mt19937 order(1); // the same popularity ranking for every bucket
+    shuffle(stops.begin(), stops.end(), order);
+    vector<double> weights;
+    for (size_t k = 0; k < stops.size(); k++) weights.push_back(1.0 / (k + 1));
+    discrete_distribution<int> popular(weights.begin(), weights.end());
+    uniform_int_distribution<int> anyNode(0, graph.nodeCount - 1);
+    uniform_real_distribution<double> unit(-1, 1);
+    
+    // lat, lon of a node or of a point up to 300 m from a stop
+    auto draw = [&]() -> pair<double,double> {
+        if (!nearStops || stops.empty()) {
+            const Node& n = graph.nodes[anyNode(rng)];
+            return {n.lat, n.lon};
+        }
+        const Node& n = graph.nodes[stops[popular(rng)]];
+        double dLat = 0.3 / 111.0, dLon = dLat / cos(n.lat * M_PI / 180);
+        return {n.lat + unit(rng) * dLat, n.lon + unit(rng) * dLon};
+    };
+    
+    vector<pair<pair<double,double>, pair<double,double>>> pairs;
+    for (int tries = 0; (int)pairs.size() < count && tries < count * 1000; tries++) {
+        auto a = draw(), b = draw();
+        double km = haversine(a.first, a.second, b.first, b.second);
+        if (km >= BUCKET_KM[bucket] && km < BUCKET_KM[bucket + 1]) pairs.push_back({a, b});
+    }
+    return pairs;
+}
+
+// value of key in one line of our own JSON output, empty if it is not there
+string jsonField(const string& line, const string& key) {
+    size_t at = line.find("\"" + key + "\": ");
+    if (at == string::npos) return "";
+    at += key.size() + 4;
+    if (line[at] == '"') return line.substr(at + 1, line.find('"', at + 1) - at - 1);
+    return line.substr(at, line.find_first_of(",}", at) - at);
+}
+
+int main(int argc, char** argv) {
+    string basePath = "/media/nym/Nym_s Files/grph-project/";
+    string jsonFile, compareFile;
+    int perBucket = 40;
+    int seed = 1;
+    bool allQueues = false;
+    
+    vector<string> args;
+    for (int i = 1; i < argc; i++) {
+        string a = argv[i];
+        if (a == "--json" && i + 1 < argc) jsonFile = argv[++i];
+        else if (a == "--compare" && i + 1 < argc) compareFile = argv[++i];
+        else if (a == "--per-bucket" && i + 1 < argc) perBucket = atoi(argv[++i]);
+        else if (a == "--seed" && i + 1 < argc) seed = atoi(argv[++i]);
+        else if (a == "--all-queues") allQueues = true;
+        else args.push_back(a);
+    }
+    if (args.size() > 0) basePath = args[0];
+    if (!basePath.empty() && basePath.back() != '/') basePath += "/";
+    
+    auto t0 = chrono::steady_clock::now();
+    Graph graph;
+    loadGraph(graph, {
+        {basePath + "Roadmap-Dhaka.csv", 0},
+        {basePath + "Routemap-DhakaMetroRail.csv", 1},
+        {basePath + "Routemap-BikolpoBus.csv", 2},
+        {basePath + "Routemap-UttaraBus.csv", 3}
+    }, basePath + "graph.snap");
+    if (graph.nodeCount == 0) {
+        cout << "No graph data found in " << basePath << "\n";
+        return 1;
+    }
+    graph.buildSpatialIndex();
+    double loadMs = msSince(t0);
+    t0 = chrono::steady_clock::now();
+    ContractionHierarchy ch;
+    loadOrBuildCH(ch, graph, basePath + "graph.ch");
+    double chMs = msSince(t0);
+    t0 = chrono::steady_clock::now();
+    TransitNetwork transit;
+    transit.build(graph);
+    double transitMs = msSince(t0);
+    CompressedGraph compressed;
+    compressed.build(graph);
+    CRPTables crp;
+    crp.build(graph);
+    long loadedKB = peakRssKB();
+    
+    vector<Variant> variants;
+    for (int queue = QUEUE_BINARY; queue <= (allQueues ? QUEUE_RADIX : QUEUE_BINARY); queue++) {
+        string suffix = queue == QUEUE_BINARY ? "" : string("/") + queueName(queue);
+        for (int type : {Q_CAR, Q_METRO, Q_ALL}) {
+            for (int algo = ALGO_DIJKSTRA; algo <= ALGO_BIDIR_ASTAR; algo++) {
+                Variant v;
+                v.name = string(queryParams(type).name) + "/" + algoName(algo) + suffix;
+                v.type = type;
+                v.algo = algo;
+                v.queue = queue;
+                variants.push_back(v);
+            }
+            Variant c;
+            c.name = string(queryParams(type).name) + "/compressed" + suffix;
+            c.type = type;
+            c.compressed = true;
+            c.queue = queue;
+            variants.push_back(c);
+            Variant r = c;
+            r.name = string(queryParams(type).name) + "/crp" + suffix;
+            r.compressed = false;
+            r.crp = true;
+            variants.push_back(r);
+            if (type == Q_CAR) {
+                Variant v;
+                v.name = "car/ch" + suffix;
+                v.type = Q_CAR;
+                v.ch = true;
+                v.queue = queue;
+                variants.push_back(v);
+            }
+        }
+        for (int type : {Q_EARLIEST, Q_TRANSIT}) {
+            Variant v;
+            v.name = queryParams(type).name + suffix;
+            v.type = type;
+            v.queue = queue;
+            variants.push_back(v);
+        }
+    }
+    for (int type : {Q_TIMED, Q_FASTEST, Q_DEADLINE}) {
+        for (bool pareto : {true, false}) {
+            Variant v;
+            v.name = string(queryParams(type).name) + (pareto ? "/pareto" : "/labels");
+            v.type = type;
+            v.pareto = pareto;
+            v.exact = pareto || type != Q_TIMED;
+            variants.push_back(v);
+        }
+    }
+    
+    // the same queries for every variant: endpoints per workload and bucket, and a
+    // start time and deadline per query
+    mt19937 rng(seed);
+    uniform_int_distribution<int> minute(timeToMins("6:00 AM"), timeToMins("9:00 PM"));
+    vector<Query> workload[2][3];
+    for (int w = 0; w < 2; w++) {
+        for (int b = 0; b < 3; b++) {
+            for (auto& [a, z] : makePairs(graph, w == 1, b, perBucket, rng)) {
+                Query q;
+                q.srcLat = a.first;
+                q.srcLon = a.second;
+                q.dstLat = z.first;
+                q.dstLon = z.second;
+                q.startMins = minute(rng);
+                q.deadlineMins = q.startMins + 30 + (int)ceil(10 * haversine(a.first, a.second, z.first, z.second));
+                workload[w][b].push_back(q);
+            }
+        }
+    }
+    
+    // answers of the first variant of each query type, which the others must match;
+    // -1 when no route was found
+    map<int, vector<double>> expected[2][3];
+    auto answer = [](int type, const QueryResult& r) {
+        if (!r.found) return -1.0;
+        if (type == Q_FASTEST) return (double)r.arrivalTime;
+        if (type == Q_EARLIEST || type == Q_TRANSIT) return r.exactArrival;
+        return r.cost;
+    };
+    vector<Row> rows;
+    bool allOk = true;
+    cout << graph.nodeCount << " nodes, " << perBucket << " queries per bucket, seed " << seed << "\n";
+    cout << "p50 / p99 ms per bucket (short, medium, long), mean settled and pushes over all buckets\n";
+    for (const Variant& v : variants) {
+        SearchWorkspace ws;
+        ws.queue = v.queue;
+        for (int w = 0; w < 2; w++) {
+            cout << "  " << left << setw(20) << v.name << setw(7) << WORKLOADS[w] << right << fixed << setprecision(3);
+            double settled = 0, pushes = 0;
+            int total = 0, bad = 0, worse = 0;
+            for (int b = 0; b < 3; b++) {
+                Row row;
+                row.variant = v.name;
+                row.workload = WORKLOADS[w];
+                row.bucket = BUCKETS[b];
+                vector<double> ms;
+                vector<double>& want = expected[w][b][v.type];
+                bool first = want.empty();
+                for (size_t i = 0; i < workload[w][b].size(); i++) {
+                    Query q = workload[w][b][i];
+                    q.type = v.type;
+                    auto t0 = chrono::steady_clock::now();
+                    QueryResult r = answerQuery(graph, q, ws, v.algo, v.ch ? &ch : nullptr, &transit, v.pareto,
+                                                v.compressed ? &compressed : nullptr, v.crp ? &crp : nullptr);
+                    ms.push_back(msSince(t0));
+                    row.found += r.found;
+                    row.settled += r.settled;
+                    row.pushes += r.pushes;
+                    double got = answer(v.type, r);
+                    if (first) {
+                        want.push_back(got);
+                        continue;
+                    }
+                    bool same = fabs(got - want[i]) <= 1e-9 * max(1.0, fabs(got));
+                    bool worse = !same && want[i] >= 0 && (got < 0 || got > want[i]);
+                    if (worse && !v.exact) row.worse++;
+                    else row.mismatches += !same;
+                }
+                row.queries = ms.size();
+                for (double t : ms) row.mean += t;
+                sort(ms.begin(), ms.end());
+                row.p50 = percentile(ms, 50);
+                row.p95 = percentile(ms, 95);
+                row.p99 = percentile(ms, 99);
+                settled += row.settled;
+                pushes += row.pushes;
+                total += row.queries;
+                bad += row.mismatches;
+                worse += row.worse;
+                if (row.queries > 0) {
+                    row.mean /= row.queries;
+                    row.settled /= row.queries;
+                    row.pushes /= row.queries;
+                }
+                row.peakKB = peakRssKB();
+                rows.push_back(row);
+                cout << "   " << setw(7) << row.p50 << " / " << setw(7) << row.p99;
+            }
+            total = max(total, 1);
+            cout << "   " << setprecision(0) << setw(7) << settled / total << setw(8) << pushes / total;
+            if (worse) cout << "   " << worse << " worse";
+            if (bad) cout << "   " << bad << " MISMATCHES";
+            cout << "\n";
+            allOk = allOk && bad == 0;
+        }
+    }
+    cout << "peak memory " << peakRssKB() / 1024 << " MB (" << loadedKB / 1024 << " MB after loading)\n";
+    
+    if (!jsonFile.empty()) {
+        ofstream out(jsonFile);
+        out << fixed << setprecision(4);
+        out << "{\n  \"suite\": \"graph-routing\", \"version\": 1, \"seed\": " << seed << ", \"per_bucket\": " << perBucket
+            << ", \"nodes\": " << graph.nodeCount << ", \"edges\": " << graph.edgeTo.size() / 2 << ",\n";
+        out << "  \"compiler\": \"" << __VERSION__ << "\", \"built\": \"" << __DATE__ << " " << __TIME__ << "\",\n";
+        out << "  \"load_ms\": " << loadMs << ", \"ch_ms\": " << chMs << ", \"transit_ms\": " << transitMs
+            << ", \"loaded_rss_kb\": " << loadedKB << ", \"peak_rss_kb\": " << peakRssKB() << ",\n";
+        out << "  \"results\": [\n";
+        for (size_t i = 0; i < rows.size(); i++) {
+            const Row& r = rows[i];
+            out << "    {\"variant\": \"" << r.variant << "\", \"workload\": \"" << r.workload << "\", \"bucket\": \""
+                << r.bucket << "\", \"queries\": " << r.queries << ", \"found\": " << r.found << ", \"p50_ms\": "
+                << r.p50 << ", \"p95_ms\": " << r.p95 << ", \"p99_ms\": " << r.p99 << ", \"mean_ms\": " << r.mean
+                << ", \"settled\": " << r.settled << ", \"pushes\": " << r.pushes << ", \"mismatches\": "
+                << r.mismatches << ", \"worse\": " << r.worse << ", \"peak_rss_kb\": " << r.peakKB << "}" << (i + 1 < rows.size() ? "," : "") << "\n";
+        }
+        out << "  ]\n}\n";
+        cout << "Wrote " << rows.size() << " results to " << jsonFile << "\n";
+    }
+    
+    if (!compareFile.empty()) {
+        ifstream in(compareFile);
+        if (!in) {
+            cout << "Cannot open " << compareFile << "\n";
+            return 1;
+        }
+        map<string, pair<double,double>> before; // variant workload bucket -> p50, p99
+        string line;
+        while (getline(in, line)) {
+            string variant = jsonField(line, "variant");
+            if (variant.empty()) continue;
+            before[variant + " " + jsonField(line, "workload") + " " + jsonField(line, "bucket")] =
+                {atof(jsonField(line, "p50_ms").c_str()), atof(jsonField(line, "p99_ms").c_str())};
+        }
+        cout << "\nchange against " << compareFile << " (new / old, p50 and p99)\n" << setprecision(2);
+        double logSum = 0;
+        int matched = 0;
+        for (const Row& r : rows) {
+            auto it = before.find(r.variant + " " + r.workload + " " + r.bucket);
+            if (it == before.end() || it->second.first <= 0 || it->second.second <= 0 || r.p50 <= 0) continue;
+            double p50 = r.p50 / it->second.first, p99 = r.p99 / it->second.second;
+            logSum += log(p50);
+            matched++;
+            cout << "  " << left << setw(20) << r.variant << setw(7) << r.workload << setw(7) << r.bucket << right
+                 << setw(6) << p50 << "x" << setw(7) << p99 << "x"
+                 << (p50 > 1.25 ? "   slower" : p50 < 0.8 ? "   faster" : "") << "\n";
+        }
+        cout << matched << " results compared, geometric mean p50 change " << (matched ? exp(logSum / matched) : 1)
+             << "x\n";
+    }
+    return allOk ? 0 : 1;
+}
@@ -0,0 +1,95 @@
+// Time-dependent engine benchmark: fastestRoute (fresh departure per transit edge,
+// whole-minute segments) against earliestArrival (one boarding per trip, fractional
+// minutes) with the problem 5 parameters on random node pairs and start times
+//
+// usage: bench_timedep [dataDir] [queries] [seed]
+#include "../common/timedep.h"
+#include "../common/query.h"
+#include <chrono>
+#include <random>
+
+double msSince(chrono::steady_clock::time_point t0) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+}
+
+void compare(const Graph& graph, string label, const QueryParams& p, const vector<tuple<int,int,int>>& work) {
+    SearchWorkspace ws;
+    int numQueries = work.size();
+    double oldMs = 0, newMs = 0, gain = 0, maxGain = 0;
+    long long settled = 0, boardings = 0, oldTransitEdges = 0;
+    int found = 0, later = 0;
+    for (int q = 0; q < numQueries; q++) {
+        auto [s, t, start] = work[q];
+        
+        auto t0 = chrono::steady_clock::now();
+        TimeResult a = fastestRoute(graph, s, t, start, p.costPerKm, p.speeds, p.intervals, p.schedStart, p.schedEnd, p.allowed);
+        oldMs += msSince(t0);
+        
+        t0 = chrono::steady_clock::now();
+        TimeDepResult b = earliestArrival(graph, s, t, start, p.costPerKm, p.speeds, p.intervals, p.schedStart, p.schedEnd,
+                                          p.allowed, ws);
+        newMs += msSince(t0);
+        
+        if (a.cost < 0 || b.cost < 0) continue;
+        found++;
+        settled += b.settled;
+        boardings += b.boardings;
+        for (int m : a.modes) oldTransitEdges += m != 0;
+        double diff = a.arrivalTime - b.arrivalTime;
+        if (diff < -1e-9) later++;
+        gain += diff;
+        maxGain = max(maxGain, diff);
+    }
+    
+    cout << label << ": " << found << " of " << numQueries << " queries with a route\n";
+    cout << fixed << setprecision(3);
+    cout << "fastestRoute     " << oldMs / numQueries << " ms/query\n";
+    cout << "earliestArrival  " << newMs / numQueries << " ms/query, " << setprecision(0)
+         << (double)settled / max(1, found) << " states settled, " << setprecision(2)
+         << (double)boardings / max(1, found) << " boardings per route\n";
+    cout << "arrival earlier by " << gain / max(1, found) << " min on average, " << maxGain << " at most; "
+         << later << " routes later\n";
+    cout << "fastestRoute waited for a departure on " << setprecision(0) << (double)oldTransitEdges / max(1, found)
+         << " transit edges per route\n";
+    cout << "\n";
+}
+
+int main(int argc, char** argv) {
+    string basePath = argc > 1 ? argv[1] : "/media/nym/Nym_s Files/grph-project/";
+    if (!basePath.empty() && basePath.back() != '/') basePath += "/";
+    int numQueries = argc > 2 ? atoi(argv[2]) : 200;
+    int seed = argc > 3 ? atoi(argv[3]) : 1;
+    
+    Graph graph;
+    loadGraph(graph, {
+        {basePath + "Roadmap-Dhaka.csv", 0},
+        {basePath + "Routemap-DhakaMetroRail.csv", 1},
+        {basePath + "Routemap-BikolpoBus.csv", 2},
+        {basePath + "Routemap-UttaraBus.csv", 3}
+    }, basePath + "graph.snap");
+    if (graph.nodeCount == 0) {
+        cout << "No graph data found in " << basePath << "\n";
+        return 1;
+    }
+    
+    // pairs of transit nodes so most routes have a reason to board
+    vector<int> stops;
+    for (int u = 0; u < graph.nodeCount; u++) {
+        if (graph.nodeModes(u) & ~modeBit(0)) stops.push_back(u);
+    }
+    mt19937 rng(seed);
+    uniform_int_distribution<int> pick(0, (int)stops.size() - 1);
+    uniform_int_distribution<int> minute(timeToMins("6:00 AM"), timeToMins("9:00 PM"));
+    
+    vector<tuple<int,int,int>> work(numQueries);
+    for (auto& w : work) w = {stops[pick(rng)], stops[pick(rng)], minute(rng)};
+    
+    compare(graph, "problem 5 parameters", queryParams(Q_FASTEST), work);
+    
+    // transit faster than driving, so routes board and ride
+    QueryParams fast = queryParams(Q_FASTEST);
+    fast.speeds[1] = 40;
+    fast.speeds[2] = fast.speeds[3] = 25;
+    compare(graph, "metro 40 km/h, buses 25 km/h", fast, work);
+    return 0;
+}
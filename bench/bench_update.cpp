@@ -0,0 +1,196 @@
+// Live update benchmark: batches of random road closures and congestion factors applied
+// to a graph that keeps answering queries. Each batch is timed on the graph and on what
+// depends on it (query cache, CRP metrics for the car and all-modes prices, transit
+// network, compressed graph), against customizing and building those from scratch;
+// after every batch the car / all queries are answered through the cache, by Dijkstra,
+// by CRP and on the compressed graph, checking that all four agree. Finally every change is undone in one batch, which must give
+// back the loaded edges and the cliques of a fresh customization.
+//
+// usage: bench_update [dataDir] [batches] [batchSize] [queries] [seed]
+#include "../common/update.h"
+#include <chrono>
+#include <random>
+
+double msSince(chrono::steady_clock::time_point t0) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+}
+
+bool sameCost(double a, double b) { return (a < 0) == (b < 0) && fabs(a - b) <= 1e-9 * max(1.0, fabs(a)); }
+
+int main(int argc, char** argv) {
+    string basePath = argc > 1 ? argv[1] : "/media/nym/Nym_s Files/grph-project/";
+    if (!basePath.empty() && basePath.back() != '/') basePath += "/";
+    int numBatches = argc > 2 ? atoi(argv[2]) : 10;
+    int batchSize = argc > 3 ? atoi(argv[3]) : 20;
+    int numQueries = argc > 4 ? atoi(argv[4]) : 200;
+    int seed = argc > 5 ? atoi(argv[5]) : 1;
+    
+    Graph graph;
+    loadGraph(graph, {
+        {basePath + "Roadmap-Dhaka.csv", 0},
+        {basePath + "Routemap-DhakaMetroRail.csv", 1},
+        {basePath + "Routemap-BikolpoBus.csv", 2},
+        {basePath + "Routemap-UttaraBus.csv", 3}
+    }, basePath + "graph.snap");
+    if (graph.nodeCount == 0) {
+        cout << "No graph data found in " << basePath << "\n";
+        return 1;
+    }
+    graph.buildSpatialIndex();
+    vector<int> edgeTo = graph.edgeTo;
+    vector<Weight> edgeDist = graph.edgeDist;
+    size_t exactBefore = graph.exactDist.size();
+    
+    // what a rebuild would cost
+    auto t0 = chrono::steady_clock::now();
+    ContractionHierarchy ch;
+    ch.build(graph);
+    double chMs = msSince(t0);
+    CRPPartition part;
+    part.build(graph);
+    const int TYPES[2] = {Q_CAR, Q_ALL};
+    CRPMetric metrics[2];
+    t0 = chrono::steady_clock::now();
+    metrics[0].customize(graph, part, CAR_PER_KM, CAR_ONLY);
+    metrics[1].customize(graph, part, queryParams(Q_ALL).costPerKm, queryParams(Q_ALL).allowed);
+    double customizeMs = msSince(t0);
+    TransitNetwork transit;
+    t0 = chrono::steady_clock::now();
+    transit.build(graph);
+    double transitMs = msSince(t0);
+    CompressedGraph compressed;
+    t0 = chrono::steady_clock::now();
+    compressed.build(graph);
+    double compressMs = msSince(t0);
+    cout << graph.nodeCount << " nodes; from scratch: hierarchy " << fixed << setprecision(1) << chMs
+         << " ms, both CRP metrics " << customizeMs << " ms, transit network " << transitMs << " ms, compressed graph "
+         << compressMs << " ms\n";
+    
+    QueryCache cache(64 << 20, 4);
+    GraphUpdater updater(graph);
+    updater.cache = &cache;
+    updater.ch = &ch;
+    updater.transit = &transit;
+    updater.compressed = &compressed;
+    updater.metrics = {&metrics[0], &metrics[1]};
+    
+    mt19937 rng(seed);
+    uniform_int_distribution<int> pick(0, graph.nodeCount - 1);
+    vector<Query> queries(numQueries);
+    for (Query& q : queries) {
+        const Node& a = graph.nodes[pick(rng)];
+        const Node& b = graph.nodes[pick(rng)];
+        q.type = TYPES[rng() % 2];
+        q.srcLon = a.lon;
+        q.srcLat = a.lat;
+        q.dstLon = b.lon;
+        q.dstLat = b.lat;
+    }
+    SearchWorkspace ws;
+    for (const Query& q : queries) answerCached(graph, q, ws, &cache);
+    
+    // queries through the cache, then Dijkstra and CRP on the same nodes, all checked
+    bool allOk = true;
+    auto runQueries = [&](double& cachedMs, double& dijkstraMs, double& crpMs) {
+        int bad = 0;
+        for (const Query& q : queries) {
+            auto s0 = chrono::steady_clock::now();
+            QueryResult cached = answerCached(graph, q, ws, &cache);
+            cachedMs += msSince(s0);
+            if (cached.start < 0 || cached.end < 0) continue;
+            const QueryParams& p = queryParams(q.type);
+            const double* costPerKm = q.type == Q_CAR ? CAR_PER_KM : p.costPerKm;
+            const bool* allowed = q.type == Q_CAR ? CAR_ONLY : p.allowed;
+            s0 = chrono::steady_clock::now();
+            CostResult fresh = cheapestRoute(graph, cached.start, cached.end, costPerKm, allowed, ws);
+            dijkstraMs += msSince(s0);
+            s0 = chrono::steady_clock::now();
+            CostResult crp = metrics[q.type == Q_CAR ? 0 : 1].query(cached.start, cached.end, ws);
+            crpMs += msSince(s0);
+            CostResult chains = compressed.cheapestRoute(cached.start, cached.end, costPerKm, allowed, ws);
+            bad += !sameCost(fresh.cost, cached.cost) || !sameCost(fresh.cost, crp.cost) ||
+                   !sameCost(fresh.cost, chains.cost);
+        }
+        return bad;
+    };
+    
+    // random open car edges, about half closed and half slowed down
+    vector<EdgeUpdate> all;
+    double graphMs = 0, dependentMs = 0, cachedMs = 0, dijkstraMs = 0, crpMs = 0;
+    long long cells = 0, dropped = 0, slots = 0, rows = 0, chains = 0;
+    int bad = 0;
+    uniform_real_distribution<double> slower(1.2, 3);
+    for (int b = 0; b < numBatches; b++) {
+        vector<EdgeUpdate> batch;
+        while ((int)batch.size() < batchSize) {
+            int u = pick(rng);
+            int first = graph.edgeBegin(u, 0), count = graph.edgeEnd(u, 0) - first;
+            if (count == 0) continue;
+            int v = graph.edgeTo[first + rng() % count];
+            if (v == u) continue;
+            EdgeUpdate up;
+            up.u = u;
+            up.v = v;
+            up.kind = rng() % 2 ? UPDATE_CLOSE : UPDATE_FACTOR;
+            up.factor = slower(rng);
+            batch.push_back(up);
+        }
+        UpdateResult res = updater.apply(batch);
+        all.insert(all.end(), batch.begin(), batch.end());
+        graphMs += res.graphMs;
+        dependentMs += res.dependentMs;
+        cells += res.cells;
+        dropped += res.dropped;
+        slots += res.slots;
+        rows += res.transitRows;
+        chains += res.chains;
+        bad += runQueries(cachedMs, dijkstraMs, crpMs);
+    }
+    int answered = numBatches * numQueries;
+    cout << numBatches << " batches of " << batchSize << " car edges (" << slots << " slots changed)\n";
+    cout << "  update: " << setprecision(3) << graphMs / numBatches << " ms on the graph, " << dependentMs / numBatches
+         << " ms on the rest per batch; " << setprecision(1) << (double)cells / numBatches << " CRP cells of "
+         << 2 * (part.cellCount[0] + part.cellCount[1] + part.cellCount[2]) << " recomputed, " << (double)dropped / numBatches
+         << " cache entries dropped and " << (double)rows / numBatches << " of " << transit.stopCount()
+         << " transit car rows recomputed and " << (double)chains / numBatches << " of " << compressed.chainCount()
+         << " compressed chains walked per batch; hierarchy " << (ch.empty() ? "cleared" : "kept") << "\n";
+    cout << "  after updates: " << setprecision(3) << cachedMs / answered << " ms/query through the cache ("
+         << cache.hits + cache.treeHits << " hits), " << dijkstraMs / answered << " ms Dijkstra, " << crpMs / answered
+         << " ms CRP; " << bad << " disagree\n";
+    allOk = allOk && bad == 0;
+    
+    // the transit network kept up to date must match one built on the changed graph
+    auto sameTransit = [&]() {
+        TransitNetwork check;
+        check.build(graph);
+        return check.carDist == transit.carDist && check.carPathStart == transit.carPathStart &&
+               check.carPathNodes == transit.carPathNodes && check.routeStops == transit.routeStops;
+    };
+    bool transitOk = sameTransit();
+    cout << "  transit network " << (transitOk ? "matches" : "DIFFERS from") << " a fresh build\n";
+    allOk = allOk && transitOk;
+    
+    // undo everything at once
+    vector<EdgeUpdate> undo;
+    for (EdgeUpdate up : all) {
+        up.kind = up.kind == UPDATE_CLOSE ? UPDATE_REOPEN : UPDATE_FACTOR;
+        up.factor = 1;
+        undo.push_back(up);
+    }
+    UpdateResult res = updater.apply(undo);
+    CRPMetric fresh[2];
+    fresh[0].customize(graph, part, CAR_PER_KM, CAR_ONLY);
+    fresh[1].customize(graph, part, queryParams(Q_ALL).costPerKm, queryParams(Q_ALL).allowed);
+    bool restored = graph.edgeTo == edgeTo && graph.edgeDist == edgeDist && graph.exactDist.size() == exactBefore &&
+                    graph.closedTo.empty() && graph.loadedLength.empty();
+    bool cliques = metrics[0].clique == fresh[0].clique && metrics[1].clique == fresh[1].clique;
+    cout << "  undo: " << res.changed << " updates in " << setprecision(3) << res.graphMs + res.dependentMs
+         << " ms, edges " << (restored ? "restored" : "NOT restored") << ", cliques "
+         << (cliques ? "match" : "DIFFER from") << " a fresh customization, cache "
+         << (res.onlyLonger ? "kept" : "emptied") << "\n";
+    bad = runQueries(cachedMs, dijkstraMs, crpMs);
+    transitOk = sameTransit();
+    cout << "  after undo: " << bad << " disagree, transit network " << (transitOk ? "matches" : "DIFFERS")
+         << "\n";
+    return allOk && restored && cliques && transitOk && bad == 0 ? 0 : 1;
+}
@@ -0,0 +1,39 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "cache.h"
+#include <thread>
+#include <atomic>
+
+// Answer a batch of queries on several threads. Each thread owns a SearchWorkspace
+// that it reuses for every query it takes; the graph is shared read-only, so its
+// spatial index is built before the threads start. With a cache, the threads share it.
+inline vector<QueryResult> answerBatch(Graph& graph, const vector<Query>& queries, int threads = 0,
+                                       int algo = ALGO_DIJKSTRA, const ContractionHierarchy* ch = nullptr,
+                                       const TransitNetwork* transit = nullptr, bool pareto = true,
+                                       int queue = QUEUE_BINARY, QueryCache* cache = nullptr,
+                                       const CompressedGraph* compressed = nullptr, const CRPTables* crp = nullptr) {
+    if (threads <= 0) threads = max(1, (int)thread::hardware_concurrency());
+    threads = max(1, min(threads, (int)queries.size()));
+    if (graph.indexDirty) graph.buildSpatialIndex();
+    
+    vector<QueryResult> results(queries.size());
+    atomic<size_t> next(0);
+    auto worker = [&]() {
+        SearchWorkspace ws;
+        ws.queue = queue;
+        for (size_t i = next++; i < queries.size(); i = next++) {
+            STATS(beginQueryStats());
+            results[i] = answerCached(graph, queries[i], ws, cache, algo, ch, transit, pareto, compressed, crp);
+            STATS(endQueryStats());
+        }
+    };
+    
+    vector<thread> pool;
+    for (int t = 1; t < threads; t++) pool.emplace_back(worker);
+    worker();
+    for (auto& th : pool) th.join();
+    return results;
+}
+
+#endif // BATCH_H
@@ -0,0 +1,350 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include "query.h"
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+// LRU cache of query answers for repeated origin-destination pairs.
+//
+// Answers are keyed on the snapped start and end nodes, the query type, its start time
+// and deadline, a hash of its price and schedule table and the search used (algorithm,
+// hierarchy, CRP, compressed graph, Pareto), so a hit returns the route the search
+// would have, with no settled nodes or pushes since none ran. Routes are kept
+// compact: modes as bytes, times only for timed queries.
+//
+// For car / metro / all queries a node that keeps coming up as an endpoint (treeAfter
+// misses) gets a one-to-all tree of cheapest costs; edges are undirected, so the tree
+// answers every later query from or to that node without a search. Those answers have
+// the tree's route, which can differ from the search's only between routes of equal
+// cost, and likewise report no search work.
+//
+// Entries and trees share one memory cap (bytes, approximate) and one LRU order. The
+// cache remembers the graph and its revision and empties itself when either changes,
+// unless it was told which edges changed (edgesChanged); a changed price table has a
+// new hash, so its old answers are never hit again and age out. All calls take a lock,
+// so threads of a batch can share one cache.
+
+// fingerprint of a query type's prices and schedules
+inline uint64_t paramHash(const QueryParams& p) {
+    uint64_t h = fnv1a(p.costPerKm, sizeof(p.costPerKm));
+    h = fnv1a(p.speeds, sizeof(p.speeds), h);
+    h = fnv1a(p.intervals, sizeof(p.intervals), h);
+    h = fnv1a(p.schedStart, sizeof(p.schedStart), h);
+    h = fnv1a(p.schedEnd, sizeof(p.schedEnd), h);
+    return fnv1a(p.allowed, sizeof(p.allowed), h);
+}
+
+struct CacheKey {
+    int type, start, end; // end -1 for a one-to-all tree of start
+    int startMins, deadlineMins;
+    int engine;           // algorithm, hierarchy, CRP, compressed graph and Pareto flag of the search
+    uint64_t params;
+    
+    bool operator==(const CacheKey& o) const {
+        return type == o.type && start == o.start && end == o.end && startMins == o.startMins &&
+               deadlineMins == o.deadlineMins && engine == o.engine && params == o.params;
+    }
+};
+
+struct CacheKeyHash {
+    size_t operator()(const CacheKey& k) const { return fnv1a(&k, sizeof(k)); }
+};
+
+// cheapest cost from one node to all others with the parent of each on its route
+struct CostTree {
+    vector<double> dist;
+    vector<int> parent;
+    vector<unsigned char> parentMode;
+};
+
+class QueryCache {
+public:
+    size_t capacity;  // bytes
+    int treeAfter;    // misses at an endpoint before it gets a tree, 0 = never
+    long long hits = 0, treeHits = 0, misses = 0, trees = 0, evictions = 0, flushes = 0, invalidated = 0;
+    
+    QueryCache(size_t capacityBytes = 64 << 20, int treeMisses = 4) : capacity(capacityBytes), treeAfter(treeMisses) {}
+    
+    size_t bytes() {
+        lock_guard<mutex> lock(mtx);
+        return used;
+    }
+    
+    size_t entries() {
+        lock_guard<mutex> lock(mtx);
+        return lru.size();
+    }
+    
+    // drop everything
+    void clear() {
+        lock_guard<mutex> lock(mtx);
+        reset();
+    }
+    
+    // The graph changed on the u-v edges of these {u, v, mode} steps and nowhere else.
+    // If no length went down, a car / metro / all answer or tree that avoids them still
+    // has a cheapest route (as with trees, possibly not the one a new search would pick
+    // between equal costs), so only those that use one are dropped, with every answer
+    // of the other types; otherwise the cache is emptied. Call it before the next
+    // lookup, which would see the new revision and empty the cache anyway.
+    void edgesChanged(const Graph& graph, const vector<array<int,3>>& steps, bool onlyLonger) {
+        lock_guard<mutex> lock(mtx);
+        if (!onlyLonger || graphSeen != &graph) {
+            if (!lru.empty()) flushes++;
+            reset();
+        } else {
+            set<array<int,3>> changed;
+            for (auto& s : steps) {
+                changed.insert(s);
+                changed.insert({s[1], s[0], s[2]});
+            }
+            auto uses = [&](const Entry& e) {
+                if (!isCostQuery(e.key.type)) return true;
+                if (e.tree) {
+                    const CostTree& t = *e.tree;
+                    for (size_t v = 0; v < t.parent.size(); v++) {
+                        if (t.parent[v] >= 0 && changed.count({t.parent[v], (int)v, t.parentMode[v]})) return true;
+                    }
+                    return false;
+                }
+                const vector<int>& path = e.result.path;
+                for (size_t k = 0; k + 1 < path.size() && k < e.modes.size(); k++) {
+                    if (changed.count({path[k], path[k + 1], e.modes[k]})) return true;
+                }
+                return false;
+            };
+            for (auto it = lru.begin(); it != lru.end();) {
+                if (!uses(*it)) {
+                    ++it;
+                    continue;
+                }
+                used -= it->bytes;
+                index.erase(it->key);
+                it = lru.erase(it);
+                invalidated++;
+            }
+        }
+        graphSeen = &graph;
+        revisionSeen = graph.revision;
+    }
+    
+    void setCapacity(size_t bytesCap) {
+        lock_guard<mutex> lock(mtx);
+        capacity = bytesCap;
+        trim();
+    }
+    
+    // answer q between r.start and r.end from the cache; false on a miss
+    bool lookup(const Graph& graph, const Query& q, const CacheKey& key, QueryResult& r) {
+        lock_guard<mutex> lock(mtx);
+        check(graph);
+        auto it = index.find(key);
+        if (it != index.end()) {
+            lru.splice(lru.begin(), lru, it->second);
+            const Entry& e = *it->second;
+            r = e.result;
+            r.modes.assign(e.modes.begin(), e.modes.end());
+            r.settled = 0; // no search ran for this answer
+            r.pushes = 0;
+            hits++;
+            return true;
+        }
+        if (isCostQuery(q.type)) {
+            for (int side = 0; side < 2; side++) {
+                CacheKey tk = treeKey(key, side ? key.end : key.start);
+                auto t = index.find(tk);
+                if (t == index.end()) continue;
+                lru.splice(lru.begin(), lru, t->second);
+                answerFromTree(*t->second->tree, side == 0, r);
+                treeHits++;
+                return true;
+            }
+        }
+        misses++;
+        return false;
+    }
+    
+    void store(const Graph& graph, const CacheKey& key, const QueryResult& r) {
+        lock_guard<mutex> lock(mtx);
+        check(graph);
+        if (index.count(key)) return;
+        Entry e;
+        e.key = key;
+        e.result = r;
+        e.result.modes.clear();
+        e.result.modes.shrink_to_fit();
+        e.modes.assign(r.modes.begin(), r.modes.end());
+        e.bytes = sizeof(Entry) + r.path.size() * sizeof(int) + e.modes.size() + r.times.size() * sizeof(int) +
+                  r.options.size() * sizeof(tuple<double,int,double>);
+        insert(move(e));
+    }
+    
+    // count a miss at node; true once it is hot enough to deserve a tree of its own
+    bool wantTree(const CacheKey& key, int node) {
+        lock_guard<mutex> lock(mtx);
+        if (treeAfter <= 0) return false;
+        if (missesAt.size() > (1u << 16)) missesAt.clear();
+        uint64_t k = (uint64_t)node * NUM_QUERY_TYPES + key.type;
+        return ++missesAt[k] == treeAfter && !index.count(treeKey(key, node));
+    }
+    
+    void storeTree(const Graph& graph, const CacheKey& key, int node, CostTree&& tree) {
+        lock_guard<mutex> lock(mtx);
+        check(graph);
+        Entry e;
+        e.key = treeKey(key, node);
+        if (index.count(e.key)) return;
+        e.bytes = sizeof(Entry) + tree.dist.size() * (sizeof(double) + sizeof(int) + 1);
+        e.tree = make_shared<CostTree>(move(tree));
+        insert(move(e));
+        trees++;
+    }
+    
+    static bool isCostQuery(int type) { return type == Q_CAR || type == Q_METRO || type == Q_ALL; }
+
+private:
+    struct Entry {
+        CacheKey key;
+        QueryResult result;            // without modes
+        vector<unsigned char> modes;
+        shared_ptr<const CostTree> tree; // set for tree entries only
+        size_t bytes = 0;
+    };
+    
+    list<Entry> lru; // most recent first
+    unordered_map<CacheKey, list<Entry>::iterator, CacheKeyHash> index;
+    unordered_map<uint64_t, int> missesAt;
+    size_t used = 0;
+    const Graph* graphSeen = nullptr;
+    unsigned revisionSeen = 0;
+    mutex mtx;
+    
+    static CacheKey treeKey(CacheKey key, int node) {
+        key.start = node;
+        key.end = -1;
+        key.startMins = key.deadlineMins = 0;
+        key.engine = 0;
+        return key;
+    }
+    
+    void reset() {
+        lru.clear();
+        index.clear();
+        missesAt.clear();
+        used = 0;
+    }
+    
+    void check(const Graph& graph) {
+        if (graphSeen == &graph && revisionSeen == graph.revision) return;
+        if (!lru.empty()) flushes++;
+        reset();
+        graphSeen = &graph;
+        revisionSeen = graph.revision;
+    }
+    
+    void insert(Entry&& e) {
+        used += e.bytes;
+        lru.push_front(move(e));
+        index[lru.front().key] = lru.begin();
+        trim();
+    }
+    
+    void trim() {
+        while (used > capacity && !lru.empty()) {
+            used -= lru.back().bytes;
+            index.erase(lru.back().key);
+            lru.pop_back();
+            evictions++;
+        }
+    }
+    
+    // the route between r.start and r.end read off the tree of one of them
+    static void answerFromTree(const CostTree& tree, bool fromStart, QueryResult& r) {
+        int root = fromStart ? r.start : r.end, leaf = fromStart ? r.end : r.start;
+        r.path.clear();
+        r.modes.clear();
+        r.settled = 0;
+        r.pushes = 0;
+        r.found = tree.dist[leaf] < INF;
+        r.cost = r.found ? tree.dist[leaf] : -1;
+        if (!r.found) return;
+        for (int v = leaf; v != root; v = tree.parent[v]) {
+            r.path.push_back(v);
+            r.modes.push_back(tree.parentMode[v]);
+        }
+        r.path.push_back(root);
+        if (fromStart) {
+            reverse(r.path.begin(), r.path.end());
+            reverse(r.modes.begin(), r.modes.end());
+        }
+    }
+};
+
+// Dijkstra from source over the whole graph with a cost query's prices
+inline CostTree buildCostTree(const Graph& graph, int type, int source, SearchWorkspace& ws) {
+    STATS(StatTimer timer(PHASE_SEARCH));
+    const QueryParams& p = queryParams(type);
+    const double* costPerKm = type == Q_CAR ? CAR_PER_KM : p.costPerKm;
+    const bool* allowed = type == Q_CAR ? CAR_ONLY : p.allowed;
+    ws.reset(graph.nodeCount);
+    ws.set(source, 0, -1, 0);
+    ws.push(0, source);
+    while (!ws.empty()) {
+        auto [c, u] = ws.pop();
+        if (c > ws.dist[u]) continue;
+        for (int m = 0; m < NUM_MODES; m++) {
+            if (!allowed[m]) continue;
+            for (int i = graph.edgeBegin(u, m); i < graph.edgeEnd(u, m); i++) {
+                int v = graph.edgeTo[i];
+                double newCost = c + graph.edgeDist[i] * costPerKm[m];
+                if (newCost < ws.get(v)) {
+                    ws.set(v, newCost, u, m);
+                    ws.push(newCost, v);
+                }
+            }
+        }
+    }
+    CostTree tree;
+    tree.dist.resize(graph.nodeCount);
+    tree.parent.resize(graph.nodeCount);
+    tree.parentMode.resize(graph.nodeCount);
+    for (int v = 0; v < graph.nodeCount; v++) {
+        tree.dist[v] = ws.get(v);
+        tree.parent[v] = tree.dist[v] < INF ? ws.parent[v] : -1;
+        tree.parentMode[v] = tree.dist[v] < INF ? ws.parentMode[v] : 0;
+    }
+    return tree;
+}
+
+// answerQuery through the cache: a hit returns the stored answer, a miss searches and
+// stores it, and an endpoint that missed often enough gets its one-to-all tree
+inline QueryResult answerCached(Graph& graph, const Query& q, SearchWorkspace& ws, QueryCache* cache,
+                                int algo = ALGO_DIJKSTRA, const ContractionHierarchy* ch = nullptr,
+                                const TransitNetwork* transit = nullptr, bool pareto = true,
+                                const CompressedGraph* compressed = nullptr, const CRPTables* crp = nullptr) {
+    if (!cache) return answerQuery(graph, q, ws, algo, ch, transit, pareto, compressed, crp);
+    QueryResult r;
+    snapQuery(graph, q, r);
+    if (r.start < 0 || r.end < 0) return r;
+    
+    const QueryParams& p = queryParams(q.type);
+    bool useCH = q.type == Q_CAR && ch && !ch->empty();
+    bool useCRP = QueryCache::isCostQuery(q.type) && !useCH && crp;
+    bool useCompressed = QueryCache::isCostQuery(q.type) && !useCH && !crp && compressed;
+    CacheKey key = {q.type, r.start, r.end, p.timeArgs > 0 ? q.startMins : 0, p.timeArgs > 1 ? q.deadlineMins : 0,
+                    algo * 16 + useCRP * 8 + useCompressed * 4 + useCH * 2 + pareto, paramHash(p)};
+    if (cache->lookup(graph, q, key, r)) return r;
+    
+    searchQuery(graph, q, r, ws, algo, ch, transit, pareto, compressed, crp);
+    cache->store(graph, key, r);
+    if (QueryCache::isCostQuery(q.type)) {
+        for (int node : {r.start, r.end}) {
+            if (cache->wantTree(key, node)) cache->storeTree(graph, key, node, buildCostTree(graph, q.type, node, ws));
+        }
+    }
+    return r;
+}
+
+#endif // CACHE_H
@@ -0,0 +1,388 @@
+#ifndef CH_H
+#define CH_H
+
+#include "routing.h"
+#include "snapshot.h"
+
+// Contraction Hierarchy over the car (mode 0) subgraph.
+//
+// Nodes are contracted one by one in order of edge difference; contracting v adds a
+// shortcut u-w for a pair of its neighbours unless a witness search finds a path
+// u..w avoiding v that is no longer. Every edge is stored once, oriented from its
+// lower-ranked to its higher-ranked end, and a query is a bidirectional Dijkstra
+// that only climbs ranks. Shortcuts remember the two edges they replace, so the
+// route is unpacked back to original graph node ids.
+
+const uint32_t CH_VERSION = 1;
+
+struct CHEdge {
+    int from, to;       // from has the lower rank
+    double weight;
+    int middle;         // contracted node the shortcut bypasses, -1 for road edges
+    int childA, childB; // the edges from-middle and middle-to (either orientation)
+};
+
+struct CHHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint64_t graphStamp;
+    uint64_t checksum;
+    uint64_t payloadBytes;
+    int32_t nodeCount;
+    int32_t edgeCount;
+};
+
+// fingerprint of the car subgraph, so a hierarchy is never used with another graph
+inline uint64_t carGraphStamp(const Graph& graph) {
+    uint64_t h = fnv1a(&graph.nodeCount, sizeof(graph.nodeCount));
+    for (int u = 0; u < graph.nodeCount; u++) {
+        int b = graph.edgeBegin(u, 0), e = graph.edgeEnd(u, 0);
+        if (b == e) continue;
+        h = fnv1a(&u, sizeof(u), h);
+        h = fnv1a(&graph.edgeTo[b], (e - b) * sizeof(int), h);
+        h = fnv1a(&graph.edgeDist[b], (e - b) * sizeof(Weight), h);
+    }
+    return h;
+}
+
+class ContractionHierarchy {
+public:
+    int nodeCount = 0;
+    uint64_t graphStamp = 0;
+    vector<int> rank;
+    vector<CHEdge> edges;
+    // upward adjacency: edges of u leading to higher ranks
+    vector<int> upStart;
+    vector<int> upEdge;
+    vector<int> upTo;
+    vector<double> upWeight;
+    
+    // witness searches give up after this many settled nodes (may add extra shortcuts)
+    int witnessLimit = 200;
+    
+    bool empty() const { return nodeCount == 0; }
+    int shortcutCount() const {
+        int c = 0;
+        for (auto& e : edges) c += e.middle >= 0;
+        return c;
+    }
+    
+    void build(const Graph& graph) {
+        nodeCount = graph.nodeCount;
+        graphStamp = carGraphStamp(graph);
+        edges.clear();
+        
+        // working adjacency {neighbour, edge id} of the not yet contracted graph
+        adjList.assign(nodeCount, {});
+        for (int u = 0; u < nodeCount; u++) {
+            for (int i = graph.edgeBegin(u, 0); i < graph.edgeEnd(u, 0); i++) {
+                int v = graph.edgeTo[i];
+                if (v <= u) continue; // each undirected edge once, no self loops
+                addOrImprove(u, v, graph.edgeDist[i], -1, -1, -1);
+            }
+        }
+        
+        rank.assign(nodeCount, -1);
+        deleted.assign(nodeCount, 0);
+        vector<vector<int>> upList(nodeCount);
+        priority_queue<pair<int,int>, vector<pair<int,int>>, greater<pair<int,int>>> order;
+        for (int v = 0; v < nodeCount; v++) order.push({priority(v), v});
+        
+        int next = 0;
+        vector<Shortcut> shortcuts;
+        while (!order.empty()) {
+            auto [p, v] = order.top();
+            order.pop();
+            if (rank[v] >= 0) continue;
+            
+            // lazy update: re-evaluate and put back if it is no longer the minimum
+            int now = priority(v);
+            if (!order.empty() && now > order.top().first) {
+                order.push({now, v});
+                continue;
+            }
+            
+            findShortcuts(v, shortcuts);
+            rank[v] = next++;
+            for (auto& [u, e] : adjList[v]) {
+                upList[v].push_back(e);
+                removeNeighbour(u, v);
+                deleted[u]++;
+            }
+            for (auto& sc : shortcuts) addOrImprove(sc.u, sc.w, sc.weight, v, sc.first, sc.second);
+            for (auto& [u, e] : adjList[v]) order.push({priority(u), u});
+            adjList[v].clear();
+        }
+        
+        for (auto& e : edges) {
+            if (rank[e.from] > rank[e.to]) swap(e.from, e.to);
+        }
+        buildUpward(upList);
+        vector<vector<pair<int,int>>>().swap(adjList);
+        vector<int>().swap(deleted);
+    }
+    
+    // shortest car distance with the route unpacked to graph node ids
+    CostResult query(int start, int end, SearchWorkspace& ws) const {
+        STATS(StatTimer timer(PHASE_SEARCH));
+        SearchWorkspace& fw = ws;
+        SearchWorkspace& bw = ws.other();
+        fw.reset(nodeCount);
+        bw.reset(nodeCount);
+        fw.set(start, 0, -1, 0);
+        fw.push(0, start);
+        bw.set(end, 0, -1, 0);
+        bw.push(0, end);
+        
+        CostResult res;
+        res.settled = 0;
+        double best = INF;
+        int meet = -1;
+        while (true) {
+            bool fOk = !fw.empty() && fw.topKey() < best;
+            bool bOk = !bw.empty() && bw.topKey() < best;
+            if (!fOk && !bOk) break;
+            bool forward = fOk && (!bOk || fw.topKey() <= bw.topKey());
+            SearchWorkspace& a = forward ? fw : bw;
+            SearchWorkspace& b = forward ? bw : fw;
+            
+            auto [d, u] = a.pop();
+            if (d > a.dist[u]) {
+                STATS(statCount(STAT_STALE));
+                continue;
+            }
+            res.settled++;
+            STATS(statCount(STAT_SETTLED));
+            
+            double other = b.get(u);
+            if (other < INF && d + other < best) {
+                best = d + other;
+                meet = u;
+            }
+            
+            STATS(statCount(STAT_RELAXED, upStart[u + 1] - upStart[u]));
+            for (int i = upStart[u]; i < upStart[u + 1]; i++) {
+                int v = upTo[i];
+                double nd = d + upWeight[i];
+                if (nd < a.get(v)) {
+                    a.set(v, nd, upEdge[i], 0);
+                    a.push(nd, v);
+                }
+            }
+        }
+        
+        if (meet < 0) {
+            res.cost = -1;
+            return res;
+        }
+        
+        // edges start..meet from the forward tree, then meet..end from the backward tree
+        STATS(StatTimer unpackTimer(PHASE_UNPACK));
+        vector<int> down;
+        for (int v = meet; fw.parent[v] != -1; v = otherEnd(fw.parent[v], v)) down.push_back(fw.parent[v]);
+        res.path.push_back(start);
+        for (int k = (int)down.size() - 1; k >= 0; k--) unpack(down[k], res.path.back(), res.path);
+        for (int v = meet; bw.parent[v] != -1; v = otherEnd(bw.parent[v], v)) unpack(bw.parent[v], v, res.path);
+        res.modes.assign(res.path.size() - 1, 0);
+        res.cost = best;
+        return res;
+    }
+    
+    bool save(const string& filename) const {
+        string payload;
+        appendSection(payload, rank.data(), nodeCount * sizeof(int));
+        appendSection(payload, edges.data(), edges.size() * sizeof(CHEdge));
+        appendSection(payload, upStart.data(), upStart.size() * sizeof(int));
+        appendSection(payload, upEdge.data(), upEdge.size() * sizeof(int));
+        
+        CHHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, "GRPHCHIE", 8);
+        header.version = CH_VERSION;
+        header.byteOrder = SNAPSHOT_BYTE_ORDER;
+        header.graphStamp = graphStamp;
+        header.checksum = payloadChecksum(payload.data(), payload.size());
+        header.payloadBytes = payload.size();
+        header.nodeCount = nodeCount;
+        header.edgeCount = edges.size();
+        
+        string tmp = filename + ".tmp";
+        ofstream file(tmp, ios::binary);
+        if (!file) return false;
+        file.write((const char*)&header, sizeof(header));
+        file.write(payload.data(), payload.size());
+        file.close();
+        if (!file) {
+            remove(tmp.c_str());
+            return false;
+        }
+        return rename(tmp.c_str(), filename.c_str()) == 0;
+    }
+    
+    // false if the file is missing, corrupt or was built for a different car graph
+    bool load(const string& filename, const Graph& graph) {
+        MappedFile file(filename);
+        if (file.size < sizeof(CHHeader)) return false;
+        CHHeader header;
+        memcpy(&header, file.data, sizeof(header));
+        const char* payload = file.data + sizeof(header);
+        
+        size_t n = header.nodeCount, m = header.edgeCount;
+        size_t fixedBytes = alignSection(n * sizeof(int)) + alignSection(m * sizeof(CHEdge)) + alignSection((n + 1) * sizeof(int));
+        bool ok = memcmp(header.magic, "GRPHCHIE", 8) == 0 &&
+                  header.version == CH_VERSION &&
+                  header.byteOrder == SNAPSHOT_BYTE_ORDER &&
+                  header.payloadBytes == file.size - sizeof(header) &&
+                  header.nodeCount == graph.nodeCount && header.edgeCount >= 0 &&
+                  fixedBytes <= header.payloadBytes &&
+                  payloadChecksum(payload, header.payloadBytes) == header.checksum &&
+                  header.graphStamp == carGraphStamp(graph);
+        if (!ok) return false;
+        
+        const int* rk = (const int*)payload;
+        const CHEdge* ed = (const CHEdge*)(payload + alignSection(n * sizeof(int)));
+        const int* us = (const int*)(payload + alignSection(n * sizeof(int)) + alignSection(m * sizeof(CHEdge)));
+        size_t upCount = us[n];
+        if (fixedBytes + alignSection(upCount * sizeof(int)) != header.payloadBytes) return false;
+        const int* ue = (const int*)(payload + fixedBytes);
+        
+        nodeCount = n;
+        graphStamp = header.graphStamp;
+        rank.assign(rk, rk + n);
+        edges.assign(ed, ed + m);
+        upStart.assign(us, us + n + 1);
+        upEdge.assign(ue, ue + upCount);
+        upTo.resize(upCount);
+        upWeight.resize(upCount);
+        for (size_t i = 0; i < upCount; i++) {
+            upTo[i] = edges[upEdge[i]].to;
+            upWeight[i] = edges[upEdge[i]].weight;
+        }
+        return true;
+    }
+
+private:
+    struct Shortcut {
+        int u, w;
+        double weight;
+        int first, second;
+    };
+    
+    vector<vector<pair<int,int>>> adjList;
+    vector<int> deleted; // contracted neighbours, spreads contraction evenly
+    SearchWorkspace witness;
+    
+    int otherEnd(int e, int v) const { return edges[e].from == v ? edges[e].to : edges[e].from; }
+    
+    // append the nodes of edge e after its endpoint a
+    void unpack(int e, int a, vector<int>& path) const {
+        const CHEdge& ed = edges[e];
+        if (ed.middle < 0) {
+            path.push_back(otherEnd(e, a));
+            return;
+        }
+        const CHEdge& c = edges[ed.childA];
+        bool aFirst = c.from == a || c.to == a;
+        unpack(aFirst ? ed.childA : ed.childB, a, path);
+        unpack(aFirst ? ed.childB : ed.childA, ed.middle, path);
+    }
+    
+    void addOrImprove(int u, int w, double weight, int middle, int childA, int childB) {
+        for (auto& [x, e] : adjList[u]) {
+            if (x != w) continue;
+            if (edges[e].weight <= weight) return;
+            // the old edge may be the child of an earlier shortcut, so replace rather than edit
+            int id = edges.size();
+            edges.push_back({u, w, weight, middle, childA, childB});
+            e = id;
+            for (auto& [y, f] : adjList[w]) {
+                if (y == u) f = id;
+            }
+            return;
+        }
+        int id = edges.size();
+        edges.push_back({u, w, weight, middle, childA, childB});
+        adjList[u].push_back({w, id});
+        adjList[w].push_back({u, id});
+    }
+    
+    void removeNeighbour(int u, int v) {
+        auto& list = adjList[u];
+        for (size_t i = 0; i < list.size(); i++) {
+            if (list[i].first == v) {
+                list[i] = list.back();
+                list.pop_back();
+                return;
+            }
+        }
+    }
+    
+    // shortcuts needed to contract v: pairs of neighbours with no witness path avoiding v
+    void findShortcuts(int v, vector<Shortcut>& out) {
+        out.clear();
+        auto& nb = adjList[v];
+        for (size_t i = 0; i + 1 < nb.size(); i++) {
+            int u = nb[i].first;
+            double wu = edges[nb[i].second].weight;
+            double limit = 0;
+            for (size_t j = i + 1; j < nb.size(); j++) limit = max(limit, wu + edges[nb[j].second].weight);
+            witnessSearch(u, v, limit);
+            for (size_t j = i + 1; j < nb.size(); j++) {
+                double via = wu + edges[nb[j].second].weight;
+                if (witness.get(nb[j].first) > via) out.push_back({u, nb[j].first, via, nb[i].second, nb[j].second});
+            }
+        }
+    }
+    
+    // bounded Dijkstra from u in the remaining graph, not passing through skip
+    void witnessSearch(int u, int skip, double limit) {
+        witness.reset(nodeCount);
+        witness.set(u, 0, -1, 0);
+        witness.push(0, u);
+        int settled = 0;
+        while (!witness.empty() && settled < witnessLimit) {
+            auto [d, x] = witness.pop();
+            if (d > witness.dist[x]) continue;
+            if (d > limit) break;
+            settled++;
+            for (auto& [y, e] : adjList[x]) {
+                if (y == skip) continue;
+                double nd = d + edges[e].weight;
+                if (nd < witness.get(y)) {
+                    witness.set(y, nd, x, 0);
+                    witness.push(nd, y);
+                }
+            }
+        }
+    }
+    
+    int priority(int v) {
+        vector<Shortcut> sc;
+        findShortcuts(v, sc);
+        return 2 * ((int)sc.size() - (int)adjList[v].size()) + deleted[v];
+    }
+    
+    void buildUpward(const vector<vector<int>>& upList) {
+        upStart.assign(nodeCount + 1, 0);
+        for (int v = 0; v < nodeCount; v++) upStart[v + 1] = upStart[v] + upList[v].size();
+        upEdge.clear();
+        for (int v = 0; v < nodeCount; v++) upEdge.insert(upEdge.end(), upList[v].begin(), upList[v].end());
+        upTo.resize(upEdge.size());
+        upWeight.resize(upEdge.size());
+        for (size_t i = 0; i < upEdge.size(); i++) {
+            upTo[i] = edges[upEdge[i]].to;
+            upWeight[i] = edges[upEdge[i]].weight;
+        }
+    }
+};
+
+// load the hierarchy stored next to the graph, or build and store it
+inline bool loadOrBuildCH(ContractionHierarchy& ch, const Graph& graph, const string& filename) {
+    if (ch.load(filename, graph)) return true;
+    ch.build(graph);
+    ch.save(filename);
+    return false;
+}
+
+#endif // CH_H
@@ -0,0 +1,455 @@
+#ifndef COMPRESS_H
+#define COMPRESS_H
+
+#include "routing.h"
+
+// Degree-2 chain compression for the cost searches (Dijkstra, A* and bidirectional,
+// see routing.h). The timed, fastest, deadline and Pareto searches stay on the full
+// graph: their edge times and waits belong to each original edge.
+//
+// Road polylines and transit routes put a node on every vertex, most of which just
+// continue one road or line. A node is kept if it is a named stop, or it does not
+// have exactly two edges of one mode to two different neighbours; every run of the
+// other (interior) nodes between two kept nodes becomes one edge whose length is
+// the sum and whose geometry is the run of interior nodes. A chain that ends in a
+// dead end (a node with one edge) is a spur and gets no edge at all, since a route
+// only goes there to start or stop. Zero-length self loops (repeated points in the
+// CSVs) are dropped, as no search can use them.
+//
+// Node ids and edge slots are unchanged. A search that starts or ends on an interior
+// node enters or leaves through the two ends of its chain, and only the final route
+// is expanded back to every graph node, so printRoute and saveKML see the same kind
+// of path. After live edge changes (update.h) only the chains around the changed
+// edges are walked again.
+
+class CompressedGraph {
+public:
+    int nodeCount = 0;
+    int keptCount = 0;
+    // one slot per slot of the graph, in Graph's CSR layout: a kept node's slot is its
+    // original edge when that leads to a kept node, else the edge along the chain it
+    // starts; every other slot (interior nodes, spurs, closed edges) points back at its
+    // own node, which no search gains from, like a closed edge in Graph
+    vector<int> edgeStart;
+    vector<int> edgeFrom;
+    vector<int> edgeTo;
+    vector<double> edgeDist;
+    vector<int> edgeChain;   // chain the edge runs along, -1 for an original edge
+    vector<char> edgeAlong;  // true if it runs from the chain's first node to its last
+    // chains: all nodes from one kept end to the other, with the distance from the
+    // first; chains replaced by update() stay here with mode -1 until the next build
+    vector<int> chainStart;
+    vector<int> chainNodes;
+    vector<double> chainDist;
+    vector<int> chainMode;
+    // per node: its chain and position in it, -1 for kept nodes
+    vector<int> nodeChain;
+    vector<int> nodePos;
+    
+    int edgeBegin(int u, int mode) const { return edgeStart[u * NUM_MODES + mode]; }
+    int edgeEnd(int u, int mode) const { return edgeStart[u * NUM_MODES + mode + 1]; }
+    int chainCount() const { return liveChains; }
+    
+    void build(const Graph& graph) {
+        this->graph = &graph;
+        nodeCount = graph.nodeCount;
+        edgeStart = graph.edgeStart;
+        edgeFrom.resize(edgeStart.back());
+        for (int u = 0; u < nodeCount; u++) {
+            for (int i = edgeBegin(u, 0); i < edgeEnd(u, NUM_MODES - 1); i++) edgeFrom[i] = u;
+        }
+        edgeTo = edgeFrom;
+        edgeDist.assign(edgeFrom.size(), 0);
+        edgeChain.assign(edgeFrom.size(), -1);
+        edgeAlong.assign(edgeFrom.size(), 1);
+        chainStart.assign(1, 0);
+        chainNodes.clear();
+        chainDist.clear();
+        chainMode.clear();
+        liveChains = 0;
+        deadChainNodes = 0;
+        nodeChain.assign(nodeCount, -1);
+        nodePos.assign(nodeCount, -1);
+        interior.assign(nodeCount, 0);
+        deadEnd.assign(nodeCount, 0);
+        
+        vector<int> all(nodeCount);
+        for (int u = 0; u < nodeCount; u++) all[u] = u;
+        keptCount = 0;
+        derive(graph, all, all);
+    }
+    
+    // follow edge changes of the graph (steps as GraphUpdater collects them): only the
+    // changed edges' ends and their neighbours can change kind, so the chains through
+    // or next to them are dropped and walked again from their kept ends, and the rest
+    // stays as it is. Dropped chains are rebuilt away once they outgrow the live ones.
+    // Returns the number of chains walked.
+    int update(const Graph& graph, const vector<array<int,3>>& steps) {
+        if (deadChainNodes > chainNodes.size() / 2) {
+            build(graph);
+            return liveChains;
+        }
+        vector<int> region;
+        for (auto& s : steps) {
+            for (int x : {s[0], s[1]}) {
+                region.push_back(x);
+                for (int i = graph.edgeBegin(x, 0); i < graph.edgeEnd(x, NUM_MODES - 1); i++) region.push_back(graph.edgeTo[i]);
+            }
+        }
+        sort(region.begin(), region.end());
+        region.erase(unique(region.begin(), region.end()), region.end());
+        
+        // chains through a node of the region or leading out of one: their other nodes
+        // join the region, and their kept ends are walked from again but keep their kind
+        // (a node kept to break a cycle would otherwise turn interior next to its chains)
+        size_t touched = region.size();
+        vector<int> ends;
+        for (size_t k = 0; k < touched; k++) {
+            int x = region[k];
+            if (nodeChain[x] >= 0) dropChain(nodeChain[x], region, ends);
+            for (int i = graph.edgeBegin(x, 0); i < graph.edgeEnd(x, NUM_MODES - 1); i++) {
+                if (nodeChain[graph.edgeTo[i]] >= 0) dropChain(nodeChain[graph.edgeTo[i]], region, ends);
+            }
+        }
+        sort(region.begin(), region.end());
+        region.erase(unique(region.begin(), region.end()), region.end());
+        vector<int> nodes = region;
+        nodes.insert(nodes.end(), ends.begin(), ends.end());
+        sort(nodes.begin(), nodes.end());
+        nodes.erase(unique(nodes.begin(), nodes.end()), nodes.end());
+        
+        int chainsBefore = chainMode.size();
+        for (int x : nodes) keptCount -= !interior[x] && !deadEnd[x];
+        derive(graph, region, nodes);
+        return chainMode.size() - chainsBefore;
+    }
+    
+    // cheapest route like cheapestRoute with the same algo, searching only kept nodes.
+    // A chain is never shorter than the straight line between its ends, so the A* and
+    // bidirectional bounds hold on its edge as they do on the edges it replaces.
+    CostResult cheapestRoute(int start, int end, const double costPerKm[], const bool allowed[], SearchWorkspace& ws,
+                             int algo = ALGO_DIJKSTRA) const {
+        STATS(StatTimer timer(PHASE_SEARCH));
+        bool bidir = algo == ALGO_BIDIR_ASTAR;
+        SearchWorkspace& fw = ws;
+        SearchWorkspace& bw = bidir ? ws.other() : ws;
+        double rate = algo == ALGO_DIJKSTRA ? 0 : minRate(costPerKm, allowed) * ASTAR_SLACK;
+        const Node& source = graph->nodes[start];
+        const Node& target = graph->nodes[end];
+        // straight line to end for A*, half its difference to the one from start both ways
+        auto potential = [&](int v) {
+            if (rate == 0) return 0.0;
+            const Node& x = graph->nodes[v];
+            double h = rate * haversine(x.lat, x.lon, target.lat, target.lon);
+            return bidir ? (h - rate * haversine(source.lat, source.lon, x.lat, x.lon)) / 2 : h;
+        };
+        
+        CostResult res;
+        res.settled = 0;
+        // the way in from start and the way out to end, through the ends of their chains;
+        // the bidirectional search starts its backward half from the way out
+        vector<pair<int,double>> sources = access(start, costPerKm, allowed);
+        vector<pair<int,double>> targets = access(end, costPerKm, allowed);
+        auto seed = [&](SearchWorkspace& a, const vector<pair<int,double>>& from, double sign) {
+            a.reset(nodeCount);
+            for (auto [v, c] : from) {
+                if (c < a.get(v)) {
+                    a.set(v, c, -1, 0);
+                    a.pot[v] = sign * potential(v);
+                    a.push(c + a.pot[v], v);
+                }
+            }
+        };
+        seed(fw, sources, 1);
+        if (bidir) seed(bw, targets, -1);
+        
+        double best = INF;
+        int meet = -1; // kept node the route passes last going forward
+        int sc = start == end ? -1 : nodeChain[start];
+        if (start == end) best = 0;
+        else if (sc >= 0 && sc == nodeChain[end] && allowed[chainMode[sc]]) {
+            best = fabs(chainDist[chainStart[sc] + nodePos[end]] - chainDist[chainStart[sc] + nodePos[start]]) *
+                   costPerKm[chainMode[sc]];
+        }
+        if (bidir) {
+            for (auto [t, tc] : targets) {
+                if (fw.get(t) + bw.get(t) < best) {
+                    best = fw.get(t) + bw.get(t);
+                    meet = t;
+                }
+            }
+        }
+        
+        while (!fw.empty() && !bw.empty()) {
+            if (bidir && fw.topKey() + bw.topKey() >= best) break;
+            
+            bool forward = !bidir || fw.topKey() <= bw.topKey();
+            SearchWorkspace& a = forward ? fw : bw;
+            SearchWorkspace& b = forward ? bw : fw;
+            auto [k, u] = a.pop();
+            double c = a.dist[u];
+            if (k > c + a.pot[u]) {
+                STATS(statCount(STAT_STALE));
+                continue;
+            }
+            if (!bidir && k >= best) break;
+            res.settled++;
+            STATS(statCount(STAT_SETTLED));
+            if (!bidir) {
+                for (auto [t, tc] : targets) {
+                    if (t == u && c + tc < best) {
+                        best = c + tc;
+                        meet = u;
+                    }
+                }
+            }
+            
+            for (int m = 0; m < NUM_MODES; m++) {
+                if (!allowed[m]) continue;
+                STATS(statCount(STAT_RELAXED, edgeEnd(u, m) - edgeBegin(u, m)));
+                for (int i = edgeBegin(u, m); i < edgeEnd(u, m); i++) {
+                    int v = edgeTo[i];
+                    double nc = c + edgeDist[i] * costPerKm[m];
+                    double old = a.get(v);
+                    if (nc < old) {
+                        double pv = old < INF ? a.pot[v] : (forward ? potential(v) : -potential(v));
+                        a.set(v, nc, i, m);
+                        a.pot[v] = pv;
+                        a.push(nc + pv, v);
+                        if (bidir && nc + b.get(v) < best) {
+                            best = nc + b.get(v);
+                            meet = v;
+                        }
+                    }
+                }
+            }
+        }
+        
+        if (best >= INF) {
+            res.cost = -1;
+            return res;
+        }
+        res.cost = best;
+        STATS(StatTimer unpackTimer(PHASE_UNPACK));
+        res.path.push_back(start);
+        if (meet < 0) { // start == end, or along their shared chain
+            if (start != end) appendChain(sc, nodePos[start], nodePos[end], res);
+            return res;
+        }
+        
+        // forward tree from the way in to meet, then the backward one on to the way out
+        vector<int> edges;
+        int first = meet;
+        for (; fw.parent[first] != -1; first = edgeFrom[fw.parent[first]]) edges.push_back(fw.parent[first]);
+        if (first != start) appendChain(nodeChain[start], nodePos[start], nearerEnd(start, first), res);
+        for (int k = (int)edges.size() - 1; k >= 0; k--) appendEdge(edges[k], res, true);
+        int last = meet;
+        if (bidir) {
+            for (; bw.parent[last] != -1; last = edgeFrom[bw.parent[last]]) appendEdge(bw.parent[last], res, false);
+        }
+        if (last != end) appendChain(nodeChain[end], nearerEnd(end, last), nodePos[end], res);
+        return res;
+    }
+
+private:
+    const Graph* graph = nullptr; // node coordinates for the search bounds
+    int liveChains = 0;
+    size_t deadChainNodes = 0;
+    // kind of each node as last derived; a node that is neither is kept
+    vector<char> interior, deadEnd;
+    
+    // Classify the nodes of classify, then walk every chain out of the kept ones among
+    // nodes (which holds classify). Nodes outside classify must be classified already,
+    // and chains through nodes must have been dropped. A node is kept if it is a named
+    // stop, or it does not have exactly two edges of one mode to two different
+    // neighbours; every run of the other (interior) nodes between two kept nodes
+    // becomes one chain, and a chain that ends in a dead end (a node with one edge) is
+    // a spur.
+    void derive(const Graph& graph, const vector<int>& classify, const vector<int>& nodes) {
+        for (int u : classify) {
+            int a, b, c, d;
+            int degree = edgeCount(graph, u, a, b);
+            interior[u] = !graph.nodes[u].isStop && degree == 2 &&
+                          graph.edgeModeAt(u, a) == graph.edgeModeAt(u, b) && graph.edgeTo[a] != graph.edgeTo[b];
+            // a pair of dead ends joined to each other stays as it is
+            deadEnd[u] = !graph.nodes[u].isStop && degree == 1 && edgeCount(graph, graph.edgeTo[a], c, d) != 1;
+            if (interior[u] || deadEnd[u]) {
+                for (int i = edgeBegin(u, 0); i < edgeEnd(u, NUM_MODES - 1); i++) setDead(i);
+            }
+        }
+        for (int u : nodes) {
+            if (!interior[u] && !deadEnd[u]) walkFrom(graph, u);
+        }
+        // cycles of interior nodes only get one kept node; a dead end left over (none
+        // in a full build) is kept rather than lost
+        for (int u : nodes) {
+            if (interior[u] && nodeChain[u] < 0) {
+                interior[u] = 0;
+                walkFrom(graph, u);
+            }
+        }
+        for (int u : nodes) {
+            if (deadEnd[u] && nodeChain[u] < 0) {
+                deadEnd[u] = 0;
+                walkFrom(graph, u);
+            }
+        }
+        for (int u : nodes) keptCount += nodeChain[u] < 0;
+    }
+    
+    // set every slot of kept node u, walking the chains behind it not walked yet
+    void walkFrom(const Graph& graph, int u) {
+        for (int i = graph.edgeBegin(u, 0); i < graph.edgeEnd(u, NUM_MODES - 1); i++) {
+            int v = graph.edgeTo[i];
+            if (v == u) {
+                setDead(i);
+            } else if (!interior[v] && !deadEnd[v]) {
+                edgeTo[i] = v;
+                edgeDist[i] = graph.edgeDist[i];
+                edgeChain[i] = -1;
+                edgeAlong[i] = 1;
+            } else if (nodeChain[v] < 0) { // else walked from the other end, which set this slot
+                walkChain(graph, u, i);
+            }
+        }
+    }
+    
+    void walkChain(const Graph& graph, int u, int i) {
+        int m = graph.edgeModeAt(u, i);
+        int c = chainMode.size();
+        chainMode.push_back(m);
+        chainNodes.push_back(u);
+        chainDist.push_back(0);
+        int prev = u, cur = graph.edgeTo[i];
+        double d = graph.edgeDist[i];
+        while (true) {
+            chainNodes.push_back(cur);
+            chainDist.push_back(d);
+            if (!interior[cur]) break;
+            nodeChain[cur] = c;
+            nodePos[cur] = chainNodes.size() - 1 - chainStart[c];
+            int a, b;
+            edgeCount(graph, cur, a, b);
+            int next = graph.edgeTo[a] != prev ? a : b;
+            prev = cur;
+            cur = graph.edgeTo[next];
+            d += graph.edgeDist[next];
+        }
+        chainStart.push_back(chainNodes.size());
+        liveChains++;
+        if (deadEnd[cur]) { // a spur: a route only goes there to start or stop
+            nodeChain[cur] = c;
+            nodePos[cur] = chainNodes.size() - 1 - chainStart[c];
+            setDead(i);
+            return;
+        }
+        setChain(i, c, true);
+        for (int j = graph.edgeBegin(cur, m); j < graph.edgeEnd(cur, m); j++) {
+            if (graph.edgeTo[j] == prev && j != i) {
+                setChain(j, c, false);
+                break;
+            }
+        }
+    }
+    
+    void setDead(int i) {
+        edgeTo[i] = edgeFrom[i];
+        edgeDist[i] = 0;
+        edgeChain[i] = -1;
+        edgeAlong[i] = 1;
+    }
+    
+    void setChain(int i, int c, bool along) {
+        edgeTo[i] = along ? chainNodes[chainStart[c + 1] - 1] : chainNodes[chainStart[c]];
+        edgeDist[i] = chainDist[chainStart[c + 1] - 1];
+        edgeChain[i] = c;
+        edgeAlong[i] = along;
+    }
+    
+    // free the nodes of chain c into region, and add its kept ends to ends
+    void dropChain(int c, vector<int>& region, vector<int>& ends) {
+        chainMode[c] = -1;
+        liveChains--;
+        deadChainNodes += chainStart[c + 1] - chainStart[c];
+        for (int k = chainStart[c]; k < chainStart[c + 1]; k++) {
+            int v = chainNodes[k];
+            if (nodeChain[v] == c) {
+                nodeChain[v] = nodePos[v] = -1;
+                region.push_back(v);
+            } else {
+                ends.push_back(v);
+            }
+        }
+    }
+    
+    // number of edges of u other than self loops, with the first two in a and b
+    static int edgeCount(const Graph& graph, int u, int& a, int& b) {
+        int found = 0;
+        a = b = -1;
+        for (int i = graph.edgeBegin(u, 0); i < graph.edgeEnd(u, NUM_MODES - 1); i++) {
+            if (graph.edgeTo[i] == u) continue;
+            if (found == 0) a = i;
+            else if (found == 1) b = i;
+            found++;
+        }
+        return found;
+    }
+    
+    // kept nodes reachable straight from v with their cost: v itself if kept,
+    // else the kept ends of its chain when the chain's mode is allowed
+    vector<pair<int,double>> access(int v, const double costPerKm[], const bool allowed[]) const {
+        int c = nodeChain[v];
+        if (c < 0) return {{v, 0}};
+        vector<pair<int,double>> ends;
+        if (!allowed[chainMode[c]]) return ends;
+        int first = chainStart[c], last = chainStart[c + 1] - 1;
+        double rate = costPerKm[chainMode[c]];
+        double d = chainDist[first + nodePos[v]];
+        if (nodeChain[chainNodes[first]] < 0) ends.push_back({chainNodes[first], d * rate});
+        if (nodeChain[chainNodes[last]] < 0) ends.push_back({chainNodes[last], (chainDist[last] - d) * rate});
+        return ends;
+    }
+    
+    // position in v's chain of its end node k; on a chain that starts and ends at k,
+    // the end nearer to v, which is the one access() gave the lower cost
+    int nearerEnd(int v, int k) const {
+        int c = nodeChain[v];
+        int first = chainStart[c], last = chainStart[c + 1] - 1;
+        if (chainNodes[first] != k) return last - first;
+        if (chainNodes[last] != k) return 0;
+        double d = chainDist[first + nodePos[v]];
+        return d <= chainDist[last] - d ? 0 : last - first;
+    }
+    
+    // append chain c's nodes after position from up to position to, either direction
+    void appendChain(int c, int from, int to, CostResult& res) const {
+        int step = to > from ? 1 : -1;
+        for (int p = from + step; p != to + step; p += step) {
+            res.path.push_back(chainNodes[chainStart[c] + p]);
+            res.modes.push_back(chainMode[c]);
+        }
+    }
+    
+    // append the nodes of edge i after the node it leaves, or (backward) after the
+    // node it reaches, walking it the other way
+    void appendEdge(int i, CostResult& res, bool forward) const {
+        int c = edgeChain[i];
+        if (c < 0) {
+            res.path.push_back(forward ? edgeTo[i] : edgeFrom[i]);
+            res.modes.push_back(mode(i));
+            return;
+        }
+        int last = chainStart[c + 1] - 1 - chainStart[c];
+        if (edgeAlong[i] == forward) appendChain(c, 0, last, res);
+        else appendChain(c, last, 0, res);
+    }
+    
+    int mode(int i) const {
+        int u = edgeFrom[i];
+        int m = 0;
+        while (edgeEnd(u, m) <= i) m++;
+        return m;
+    }
+};
+
+#endif // COMPRESS_H
@@ -0,0 +1,424 @@
+#ifndef CRP_H
+#define CRP_H
+
+#include "routing.h"
+
+// Customizable route planning for cheapestRoute-style cost queries.
+//
+// CRPPartition splits the nodes into nested cells (recursive small edge cuts, see
+// split) and records each cell's boundary nodes; it does not depend on prices.
+// CRPMetric customizes it for one costPerKm / allowed table by computing, bottom-up,
+// the cheapest cost between every pair of boundary nodes of every cell. A query then
+// runs Dijkstra on the original edges only inside the cells of start and end and
+// jumps across every other cell through its boundary clique, on the coarsest level
+// that does not contain start or end. Clique hops are unpacked by searching inside
+// the cell again, so routes come back as graph nodes and modes.
+
+class CRPPartition {
+public:
+    int nodeCount = 0;
+    int levels = 0;
+    vector<int> cellSize;               // largest cell per level, level 0 is the finest
+    vector<vector<int>> cell;           // cell[l][v]: v's cell on level l
+    vector<int> cellCount;
+    vector<vector<int>> boundaryStart;  // boundary nodes of cell c are boundaryNodes[l][boundaryStart[l][c]..]
+    vector<vector<int>> boundaryNodes;
+    vector<vector<int>> boundaryIndex;  // position of v among its cell's boundary nodes, -1 if interior
+    vector<vector<size_t>> cliqueStart; // offset of each cell's b*b matrix in a level's clique array
+    vector<size_t> cliqueSize;
+    
+    // cell sizes must grow from level to level; the cells of each level are unions
+    // of cells of the level below
+    void build(const Graph& graph, vector<int> sizes = {128, 1024, 8192}) {
+        nodeCount = graph.nodeCount;
+        levels = sizes.size();
+        cellSize = sizes;
+        cell.assign(levels, vector<int>(nodeCount, -1));
+        cellCount.assign(levels, 0);
+        
+        vector<int> order(nodeCount);
+        for (int i = 0; i < nodeCount; i++) order[i] = i;
+        split(graph, order, 0, nodeCount);
+        
+        boundaryStart.assign(levels, {});
+        boundaryNodes.assign(levels, {});
+        boundaryIndex.assign(levels, vector<int>(nodeCount, -1));
+        cliqueStart.assign(levels, {});
+        cliqueSize.assign(levels, 0);
+        for (int l = 0; l < levels; l++) {
+            // a node is on the boundary if any edge, whatever its mode, leaves the cell
+            vector<vector<int>> lists(cellCount[l]);
+            for (int u = 0; u < nodeCount; u++) {
+                for (int i = graph.edgeBegin(u, 0); i < graph.edgeEnd(u, NUM_MODES - 1); i++) {
+                    if (cell[l][graph.edgeTo[i]] != cell[l][u]) {
+                        boundaryIndex[l][u] = lists[cell[l][u]].size();
+                        lists[cell[l][u]].push_back(u);
+                        break;
+                    }
+                }
+            }
+            boundaryStart[l].assign(cellCount[l] + 1, 0);
+            cliqueStart[l].assign(cellCount[l] + 1, 0);
+            for (int c = 0; c < cellCount[l]; c++) {
+                size_t b = lists[c].size();
+                boundaryStart[l][c + 1] = boundaryStart[l][c] + b;
+                cliqueStart[l][c + 1] = cliqueStart[l][c] + b * b;
+                boundaryNodes[l].insert(boundaryNodes[l].end(), lists[c].begin(), lists[c].end());
+            }
+            cliqueSize[l] = cliqueStart[l][cellCount[l]];
+        }
+    }
+    
+    int boundaryCount(int l, int c) const { return boundaryStart[l][c + 1] - boundaryStart[l][c]; }
+
+private:
+    // scratch for the min-cut splits
+    vector<int> twin;      // reverse arc of every edge, -1 if the edge has none
+    vector<int> flow;      // skew symmetric: flow[twin[i]] == -flow[i]
+    vector<int> inRange, seen, via;
+    vector<char> role;     // 1 source, 2 sink, 'S' picked side
+    int rangeStamp = 0, bfsStamp = 0;
+    
+    // Inertial flow: order the range along a direction, take its first and last
+    // quarter as sources and sinks and cut between them with a unit-capacity max
+    // flow. The direction with the smallest cut wins. A range becomes the level l
+    // cell of all its nodes once it fits in sizes[l].
+    void split(const Graph& graph, vector<int>& order, int lo, int hi) {
+        int n = hi - lo;
+        for (int l = levels - 1; l >= 0; l--) {
+            if (n <= cellSize[l] && cell[l][order[lo]] < 0) {
+                int c = cellCount[l]++;
+                for (int i = lo; i < hi; i++) cell[l][order[i]] = c;
+            }
+        }
+        if (n <= cellSize[0]) return;
+        
+        if (twin.empty()) initFlow(graph);
+        int range = ++rangeStamp;
+        double meanLat = 0;
+        for (int i = lo; i < hi; i++) {
+            inRange[order[i]] = range;
+            meanLat += graph.nodes[order[i]].lat;
+        }
+        double scale = cos(meanLat / n * PI / 180.0);
+        
+        const double dirs[4][2] = {{1, 0}, {0, 1}, {1, 1}, {1, -1}}; // lon, lat weights
+        vector<int> nodes(order.begin() + lo, order.begin() + hi);
+        vector<int> side, best;
+        int bestCut = INT_MAX;
+        for (auto& d : dirs) {
+            auto key = [&](int v) { return d[0] * graph.nodes[v].lon * scale + d[1] * graph.nodes[v].lat; };
+            sort(nodes.begin(), nodes.end(), [&](int a, int b) {
+                double ka = key(a), kb = key(b);
+                return ka != kb ? ka < kb : a < b;
+            });
+            int cut = minCut(graph, nodes, max(1, n / 4), range, side);
+            if (cut < bestCut) {
+                bestCut = cut;
+                best.swap(side);
+            }
+        }
+        
+        for (int v : best) role[v] = 'S';
+        int mid = stable_partition(order.begin() + lo, order.begin() + hi, [&](int v) { return role[v] == 'S'; }) - order.begin();
+        for (int v : best) role[v] = 0;
+        split(graph, order, lo, mid);
+        split(graph, order, mid, hi);
+    }
+    
+    void initFlow(const Graph& graph) {
+        int m = graph.edgeTo.size();
+        twin.assign(m, -1);
+        flow.assign(m, 0);
+        inRange.assign(nodeCount, 0);
+        seen.assign(nodeCount, 0);
+        via.assign(nodeCount, -1);
+        role.assign(nodeCount, 0);
+        // edges are stored in both directions; pair each with an unpaired reverse copy
+        for (int u = 0; u < nodeCount; u++) {
+            for (int i = graph.edgeBegin(u, 0); i < graph.edgeEnd(u, NUM_MODES - 1); i++) {
+                int v = graph.edgeTo[i];
+                if (twin[i] >= 0 || v == u) continue;
+                for (int j = graph.edgeBegin(v, 0); j < graph.edgeEnd(v, NUM_MODES - 1); j++) {
+                    if (graph.edgeTo[j] == u && twin[j] < 0 && graph.edgeModeAt(v, j) == graph.edgeModeAt(u, i)) {
+                        twin[i] = j;
+                        twin[j] = i;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    
+    // max flow from the first k nodes to the last k inside the range; fills side
+    // with the nodes the sources can still reach and returns the cut size
+    int minCut(const Graph& graph, const vector<int>& nodes, int k, int range, vector<int>& side) {
+        int n = nodes.size();
+        for (int i = 0; i < k; i++) role[nodes[i]] = 1;
+        for (int i = n - k; i < n; i++) role[nodes[i]] = 2;
+        
+        vector<int> touched, queue;
+        int cut = 0;
+        while (true) {
+            int stamp = ++bfsStamp;
+            queue.clear();
+            for (int i = 0; i < k; i++) {
+                seen[nodes[i]] = stamp;
+                via[nodes[i]] = -1;
+                queue.push_back(nodes[i]);
+            }
+            int found = -1;
+            for (size_t q = 0; q < queue.size() && found < 0; q++) {
+                int u = queue[q];
+                for (int i = graph.edgeBegin(u, 0); i < graph.edgeEnd(u, NUM_MODES - 1); i++) {
+                    int v = graph.edgeTo[i];
+                    if (twin[i] < 0 || flow[i] >= 1 || inRange[v] != range || seen[v] == stamp) continue;
+                    seen[v] = stamp;
+                    via[v] = i;
+                    if (role[v] == 2) {
+                        found = v;
+                        break;
+                    }
+                    queue.push_back(v);
+                }
+            }
+            if (found < 0) {
+                side = queue;
+                break;
+            }
+            for (int v = found; via[v] >= 0; v = graph.edgeTo[twin[via[v]]]) {
+                flow[via[v]]++;
+                flow[twin[via[v]]]--;
+                touched.push_back(via[v]);
+            }
+            cut++;
+        }
+        
+        for (int i : touched) flow[i] = flow[twin[i]] = 0;
+        for (int v : nodes) role[v] = 0;
+        return cut;
+    }
+};
+
+// parentMode values from NUM_MODES up mark a clique hop of level parentMode - NUM_MODES
+const int CRP_CLIQUE_HOP = NUM_MODES;
+
+class CRPMetric {
+public:
+    const Graph* graph = nullptr;
+    const CRPPartition* part = nullptr;
+    double costPerKm[NUM_MODES];
+    bool allowed[NUM_MODES];
+    vector<vector<double>> clique; // clique[l]: cost between boundary nodes, row = from
+    
+    void customize(const Graph& g, const CRPPartition& p, const double rates[], const bool modes[]) {
+        graph = &g;
+        part = &p;
+        for (int m = 0; m < NUM_MODES; m++) {
+            costPerKm[m] = rates[m];
+            allowed[m] = modes[m];
+        }
+        clique.assign(p.levels, {});
+        SearchWorkspace ws;
+        for (int l = 0; l < p.levels; l++) {
+            clique[l].assign(p.cliqueSize[l], INF);
+            for (int c = 0; c < p.cellCount[l]; c++) customizeCell(l, c, ws);
+        }
+    }
+    
+    // after live changes to the u-v edges of the given {u, v, mode} steps, recompute
+    // only the cliques that can see them, bottom-up: on each level the cell holding both
+    // ends (an edge between two cells of a level is in none of its cliques), which also
+    // covers the cells above a recomputed one. Returns the number of cells recomputed.
+    int recustomize(const vector<array<int,3>>& steps) {
+        const CRPPartition& p = *part;
+        SearchWorkspace ws;
+        int cells = 0;
+        for (int l = 0; l < p.levels; l++) {
+            vector<int> dirty;
+            for (auto& s : steps) {
+                if (allowed[s[2]] && p.cell[l][s[0]] == p.cell[l][s[1]]) dirty.push_back(p.cell[l][s[0]]);
+            }
+            sort(dirty.begin(), dirty.end());
+            dirty.erase(unique(dirty.begin(), dirty.end()), dirty.end());
+            for (int c : dirty) customizeCell(l, c, ws);
+            cells += dirty.size();
+        }
+        return cells;
+    }
+    
+    // bidirectional: both sides pick the level of a node the same way and the graph
+    // is undirected, so the backward side walks the same edges and cliques
+    CostResult query(int start, int end, SearchWorkspace& ws) const {
+        STATS(StatTimer timer(PHASE_SEARCH));
+        SearchWorkspace& fw = ws;
+        SearchWorkspace& bw = ws.other();
+        const CRPPartition& p = *part;
+        CostResult res;
+        res.settled = 0;
+        fw.reset(graph->nodeCount);
+        bw.reset(graph->nodeCount);
+        fw.set(start, 0, -1, 0);
+        fw.push(0, start);
+        bw.set(end, 0, -1, 0);
+        bw.push(0, end);
+        
+        Meeting toBackward{&bw, start == end ? 0 : INF, start == end ? start : -1};
+        Meeting toForward{&fw, INF, -1};
+        while (!fw.empty() && !bw.empty()) {
+            double best = min(toBackward.best, toForward.best);
+            if (fw.topKey() + bw.topKey() >= best) break;
+            
+            bool forward = fw.topKey() <= bw.topKey();
+            SearchWorkspace& a = forward ? fw : bw;
+            Meeting& meet = forward ? toBackward : toForward;
+            auto [c, u] = a.pop();
+            if (c > a.dist[u]) {
+                STATS(statCount(STAT_STALE));
+                continue;
+            }
+            res.settled++;
+            STATS(statCount(STAT_SETTLED));
+            
+            // coarsest level whose cell around u holds neither start nor end
+            int level = -1;
+            for (int l = p.levels - 1; l >= 0; l--) {
+                if (p.cell[l][u] != p.cell[l][start] && p.cell[l][u] != p.cell[l][end]) {
+                    level = l;
+                    break;
+                }
+            }
+            if (level >= 0) relaxClique(level, u, c, a, &meet);
+            relaxEdges(u, c, level, a, -1, -1, &meet);
+        }
+        
+        int meet = toBackward.best <= toForward.best ? toBackward.node : toForward.node;
+        if (meet < 0) {
+            res.cost = -1;
+            return res;
+        }
+        res.cost = min(toBackward.best, toForward.best);
+        STATS(StatTimer unpackTimer(PHASE_UNPACK));
+        
+        // hops start..meet, then meet..end, each clique hop expanded in place
+        vector<pair<int,int>> hops;
+        for (int v = meet; fw.parent[v] != -1; v = fw.parent[v]) hops.push_back({v, fw.parentMode[v]});
+        reverse(hops.begin(), hops.end());
+        for (int v = meet; bw.parent[v] != -1; v = bw.parent[v]) hops.push_back({bw.parent[v], bw.parentMode[v]});
+        res.path.push_back(start);
+        for (auto [v, mode] : hops) appendHop(res.path.back(), v, mode, res, fw);
+        return res;
+    }
+    
+    CostResult query(int start, int end) const {
+        SearchWorkspace ws;
+        return query(start, end, ws);
+    }
+
+private:
+    // clique of one cell: a search inside it from each of its boundary nodes
+    void customizeCell(int l, int c, SearchWorkspace& ws) {
+        const CRPPartition& p = *part;
+        int first = p.boundaryStart[l][c];
+        int b = p.boundaryCount(l, c);
+        double* row = &clique[l][p.cliqueStart[l][c]];
+        for (int i = 0; i < b; i++, row += b) {
+            cellSearch(l, p.boundaryNodes[l][first + i], -1, ws);
+            for (int j = 0; j < b; j++) row[j] = ws.get(p.boundaryNodes[l][first + j]);
+        }
+    }
+    
+    // best route through a node reached by both searches
+    struct Meeting {
+        const SearchWorkspace* other;
+        double best;
+        int node;
+        
+        void check(int v, double c) {
+            double o = other->get(v);
+            if (o < INF && c + o < best) {
+                best = c + o;
+                node = v;
+            }
+        }
+    };
+    
+    // original edges of u; with level >= 0 only those leaving u's cell on that level.
+    // Only the query's own search (the one with a meeting) counts them in the stats.
+    void relaxEdges(int u, double c, int level, SearchWorkspace& ws, int onlyCell = -1, int cellLevel = -1,
+                    Meeting* meet = nullptr) const {
+        const Graph& g = *graph;
+        for (int m = 0; m < NUM_MODES; m++) {
+            if (!allowed[m]) continue;
+            STATS(if (meet) statCount(STAT_RELAXED, g.edgeEnd(u, m) - g.edgeBegin(u, m)));
+            for (int i = g.edgeBegin(u, m); i < g.edgeEnd(u, m); i++) {
+                int v = g.edgeTo[i];
+                if (level >= 0 && part->cell[level][v] == part->cell[level][u]) continue;
+                if (onlyCell >= 0 && part->cell[cellLevel][v] != onlyCell) continue;
+                double nc = c + g.edgeDist[i] * costPerKm[m];
+                if (nc < ws.get(v)) {
+                    ws.set(v, nc, u, m);
+                    ws.push(nc, v);
+                    if (meet) meet->check(v, nc);
+                }
+            }
+        }
+    }
+    
+    // clique of u's cell on the level; u must be one of its boundary nodes
+    void relaxClique(int level, int u, double c, SearchWorkspace& ws, Meeting* meet = nullptr) const {
+        const CRPPartition& p = *part;
+        int cl = p.cell[level][u];
+        int first = p.boundaryStart[level][cl];
+        int b = p.boundaryCount(level, cl);
+        const double* row = &clique[level][p.cliqueStart[level][cl] + (size_t)p.boundaryIndex[level][u] * b];
+        STATS(if (meet) statCount(STAT_RELAXED, b));
+        for (int j = 0; j < b; j++) {
+            if (row[j] >= INF) continue;
+            int v = p.boundaryNodes[level][first + j];
+            double nc = c + row[j];
+            if (nc < ws.get(v)) {
+                ws.set(v, nc, u, CRP_CLIQUE_HOP + level);
+                ws.push(nc, v);
+                if (meet) meet->check(v, nc);
+            }
+        }
+    }
+    
+    // Dijkstra from source that stays inside source's cell on the level, over the
+    // original edges on level 0 and over the level below's cliques and cut edges above
+    void cellSearch(int level, int source, int target, SearchWorkspace& ws) const {
+        const CRPPartition& p = *part;
+        int home = p.cell[level][source];
+        ws.reset(graph->nodeCount);
+        ws.set(source, 0, -1, 0);
+        ws.push(0, source);
+        while (!ws.empty()) {
+            auto [c, u] = ws.pop();
+            if (c > ws.dist[u]) continue;
+            if (u == target) break;
+            if (level == 0) {
+                relaxEdges(u, c, -1, ws, home, 0);
+            } else {
+                relaxClique(level - 1, u, c, ws);
+                relaxEdges(u, c, level - 1, ws, home, level);
+            }
+        }
+    }
+    
+    // append the nodes and modes of the hop from u to v, expanding clique hops
+    void appendHop(int u, int v, int mode, CostResult& res, SearchWorkspace& inner) const {
+        if (mode < CRP_CLIQUE_HOP) {
+            res.path.push_back(v);
+            res.modes.push_back(mode);
+            return;
+        }
+        int level = mode - CRP_CLIQUE_HOP;
+        cellSearch(level, u, v, inner);
+        vector<pair<int,int>> hops;
+        for (int x = v; inner.parent[x] != -1; x = inner.parent[x]) hops.push_back({x, inner.parentMode[x]});
+        for (int k = (int)hops.size() - 1; k >= 0; k--) appendHop(res.path.back(), hops[k].first, hops[k].second, res, inner);
+    }
+};
+
+#endif // CRP_H
@@ -11,8 +11,19 @@
 #include <cmath>
 #include <string>
 #include <algorithm>
+#include <array>
 #include <climits>
 #include <iomanip>
+#include <string_view>
+#include <cstring>
+#include <cstdint>
+#include <unordered_map>
+#include <charconv>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "stats.h"
 
 using namespace std;
 
@@ -39,54 +50,556 @@ inline long long makeKey(double lat, double lon) {
     return latKey * 10000000LL + lonKey;
 }
 
+// open-addressing (linear probing) map from makeKey() to node id
+class NodeIndex {
+public:
+    static const long long EMPTY = LLONG_MIN;
+    vector<long long> keys;
+    vector<int> ids;
+    size_t count = 0;
+    
+    size_t size() const { return count; }
+    
+    void clear() {
+        keys.clear();
+        ids.clear();
+        count = 0;
+    }
+    
+    // make room for n keys without rehashing (load factor <= 1/2)
+    void reserve(size_t n) {
+        size_t cap = 16;
+        while (cap < 2 * n) cap <<= 1;
+        if (cap > keys.size()) rehash(cap);
+    }
+    
+    // id stored for key, or -1
+    int find(long long key) const {
+        if (keys.empty()) return -1;
+        size_t mask = keys.size() - 1;
+        for (size_t i = slot(key, mask); ; i = (i + 1) & mask) {
+            if (keys[i] == key) return ids[i];
+            if (keys[i] == EMPTY) return -1;
+        }
+    }
+    
+    // single probe sequence: returns the existing id, or stores newId and sets inserted
+    int findOrInsert(long long key, int newId, bool& inserted) {
+        if (2 * (count + 1) > keys.size()) rehash(max((size_t)16, keys.size() * 2));
+        size_t mask = keys.size() - 1;
+        for (size_t i = slot(key, mask); ; i = (i + 1) & mask) {
+            if (keys[i] == key) {
+                inserted = false;
+                return ids[i];
+            }
+            if (keys[i] == EMPTY) {
+                keys[i] = key;
+                ids[i] = newId;
+                count++;
+                inserted = true;
+                return newId;
+            }
+        }
+    }
+
+private:
+    static size_t slot(long long key, size_t mask) {
+        unsigned long long h = (unsigned long long)key;
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        return h & mask;
+    }
+    
+    void rehash(size_t cap) {
+        vector<long long> oldKeys(cap, EMPTY);
+        vector<int> oldIds(cap, -1);
+        oldKeys.swap(keys);
+        oldIds.swap(ids);
+        size_t mask = cap - 1;
+        for (size_t j = 0; j < oldKeys.size(); j++) {
+            if (oldKeys[j] == EMPTY) continue;
+            size_t i = slot(oldKeys[j], mask);
+            while (keys[i] != EMPTY) i = (i + 1) & mask;
+            keys[i] = oldKeys[j];
+            ids[i] = oldIds[j];
+        }
+    }
+};
+
+// Storage mode. Build with -DCOMPACT_GRAPH to fit larger networks: coordinates are kept
+// as 32-bit microdegrees (the resolution makeKey merges nodes at) and frozen edge lengths
+// as floats, so a node takes 12 bytes instead of 24 and an edge 8 instead of 12. The
+// searches then add float lengths, off by at most one part in 2^24 per edge. Graph's
+// exactness guard keeps reported lengths exact: edgeLength recomputes a step from the
+// coordinates, which gives back the loaded length whenever the input had at most six
+// decimals, and freeze() keeps the lengths that do not come back this way in a side
+// table. Coordinates with more decimals are rounded and counted in roundedCoords.
+#ifdef COMPACT_GRAPH
+// a coordinate in whole microdegrees that reads and assigns like a double
+struct FixedCoord {
+    int32_t micro = 0;
+    
+    FixedCoord() {}
+    FixedCoord(double deg) : micro((int32_t)llround(deg * 1e6)) {}
+    operator double() const { return micro / 1e6; }
+};
+
+typedef FixedCoord Coord;
+typedef float Weight;
+#else
+typedef double Coord;
+typedef double Weight;
+#endif
+
 struct Edge {
     int to;
     double dist;
     int mode; // 0=car, 1=metro, 2=bikalpa, 3=uttara
 };
 
+// names live in Graph's side table, see nodeName()
 struct Node {
-    double lat, lon;
-    string name;
+    Coord lat, lon;
     bool isStop;
 };
 
+const int NUM_MODES = 4;
+const int ALL_MODES = (1 << NUM_MODES) - 1;
+
+inline int modeBit(int mode) { return 1 << mode; }
+
+// uniform grid over node coordinates for nearest-node snapping
+// cells are stored bucket-contiguous (cellStart / ids), ids ascending inside a cell
+class SpatialGrid {
+public:
+    double minLat = 0, minLon = 0, cellH = 1, cellW = 1;
+    int rows = 0, cols = 0;
+    double cosMin = 1; // smallest cos(lat) over the box, for longitude bounds
+    vector<int> cellStart;
+    vector<int> ids;
+    vector<Coord> lats, lons;
+    
+    bool empty() const { return ids.empty(); }
+    
+    void build(const vector<Node>& nodes, const vector<int>& members) {
+        cellStart.clear(); ids.clear(); lats.clear(); lons.clear();
+        rows = cols = 0;
+        if (members.empty()) return;
+        
+        double maxLat = -INF, maxLon = -INF;
+        minLat = INF; minLon = INF;
+        for (int id : members) {
+            double lat = nodes[id].lat, lon = nodes[id].lon;
+            minLat = min(minLat, lat); maxLat = max(maxLat, lat);
+            minLon = min(minLon, lon); maxLon = max(maxLon, lon);
+        }
+        
+        // aim for ~2 nodes per cell with roughly square cells on the ground
+        double midCos = max(0.01, cos((minLat + maxLat) / 2 * PI / 180.0));
+        double h = max(maxLat - minLat, 1e-6), w = max((maxLon - minLon) * midCos, 1e-6);
+        double cellSide = sqrt(h * w / max(1.0, members.size() / 2.0));
+        rows = max(1, min(4096, (int)ceil(h / cellSide)));
+        cols = max(1, min(4096, (int)ceil(w / cellSide)));
+        cellH = max(maxLat - minLat, 1e-6) / rows;
+        cellW = max(maxLon - minLon, 1e-6) / cols;
+        double maxAbsLat = max(fabs(minLat), fabs(maxLat));
+        cosMin = cos(min(90.0, maxAbsLat) * PI / 180.0);
+        
+        vector<int> cellOf(members.size());
+        cellStart.assign(rows * cols + 1, 0);
+        for (size_t i = 0; i < members.size(); i++) {
+            cellOf[i] = cellIndex(nodes[members[i]].lat, nodes[members[i]].lon);
+            cellStart[cellOf[i] + 1]++;
+        }
+        for (int c = 0; c < rows * cols; c++) cellStart[c + 1] += cellStart[c];
+        
+        vector<int> fill(cellStart.begin(), cellStart.end() - 1);
+        ids.resize(members.size());
+        for (size_t i = 0; i < members.size(); i++) ids[fill[cellOf[i]]++] = members[i];
+        for (int c = 0; c < rows * cols; c++) sort(ids.begin() + cellStart[c], ids.begin() + cellStart[c + 1]);
+        
+        lats.resize(ids.size()); lons.resize(ids.size());
+        for (size_t i = 0; i < ids.size(); i++) {
+            lats[i] = nodes[ids[i]].lat;
+            lons[i] = nodes[ids[i]].lon;
+        }
+    }
+    
+    int rowOf(double lat) const { return max(0, min(rows - 1, (int)floor((lat - minLat) / cellH))); }
+    int colOf(double lon) const { return max(0, min(cols - 1, (int)floor((lon - minLon) / cellW))); }
+    int cellIndex(double lat, double lon) const { return rowOf(lat) * cols + colOf(lon); }
+    
+    // k nearest members as {distance, id}, ordered like a linear scan would rank them
+    void nearest(double lat, double lon, int k, vector<pair<double,int>>& out) const {
+        nearest(lat, lon, k, out, [](int) { return true; });
+    }
+    
+    // the same over the members keep(id) accepts
+    template <class Keep>
+    void nearest(double lat, double lon, int k, vector<pair<double,int>>& out, Keep keep) const {
+        out.clear();
+        if (empty() || k <= 0) return;
+        
+        int cr = rowOf(lat), cc = colOf(lon);
+        vector<pair<double,int>>& best = out; // max-heap on (dist, id)
+        
+        for (int r = 0; ; r++) {
+            for (int row = cr - r; row <= cr + r; row++) {
+                if (row < 0 || row >= rows) continue;
+                bool edgeRow = (row == cr - r || row == cr + r);
+                for (int col = cc - r; col <= cc + r; col += (edgeRow ? 1 : 2 * r)) {
+                    if (col >= 0 && col < cols) scanCell(row * cols + col, lat, lon, k, best, keep);
+                    if (r == 0) break;
+                }
+            }
+            
+            bool covered = cr - r <= 0 && cr + r >= rows - 1 && cc - r <= 0 && cc + r >= cols - 1;
+            if (covered) break;
+            if ((int)best.size() == k && ringLowerBound(lat, lon, cr, cc, r) > best.front().first) break;
+        }
+        
+        sort_heap(best.begin(), best.end());
+    }
+
+private:
+    template <class Keep>
+    void scanCell(int cell, double lat, double lon, int k, vector<pair<double,int>>& best, Keep& keep) const {
+        for (int i = cellStart[cell]; i < cellStart[cell + 1]; i++) {
+            if (!keep(ids[i])) continue;
+            pair<double,int> cand = {haversine(lat, lon, lats[i], lons[i]), ids[i]};
+            if ((int)best.size() < k) {
+                best.push_back(cand);
+                push_heap(best.begin(), best.end());
+            } else if (cand < best.front()) {
+                pop_heap(best.begin(), best.end());
+                best.back() = cand;
+                push_heap(best.begin(), best.end());
+            }
+        }
+    }
+    
+    // lower bound (km) on the distance to any member outside the (2r+1)^2 block around (cr, cc)
+    double ringLowerBound(double lat, double lon, int cr, int cc, int r) const {
+        double gap = INF;
+        if (cr - r > 0) gap = min(gap, (lat - (minLat + (cr - r) * cellH)) * PI / 180.0 * EARTH_RADIUS);
+        if (cr + r < rows - 1) gap = min(gap, ((minLat + (cr + r + 1) * cellH) - lat) * PI / 180.0 * EARTH_RADIUS);
+        double lonGap = INF;
+        if (cc - r > 0) lonGap = min(lonGap, lon - (minLon + (cc - r) * cellW));
+        if (cc + r < cols - 1) lonGap = min(lonGap, (minLon + (cc + r + 1) * cellW) - lon);
+        if (lonGap < INF) {
+            double c = min(cosMin, cos(min(90.0, fabs(lat)) * PI / 180.0));
+            double s = c * sin(min(PI, max(0.0, lonGap) * PI / 180.0) / 2);
+            gap = min(gap, 2 * EARTH_RADIUS * asin(min(1.0, s)));
+        }
+        return max(0.0, gap) * (1 - 1e-9);
+    }
+};
+
 class Graph {
 public:
-    map<long long, int> nodeMap;
+    NodeIndex nodeMap;
     vector<Node> nodes;
     vector<vector<Edge>> adj;
     int nodeCount = 0;
+    unsigned revision = 0; // bumped by every change to nodes or edges, so caches can tell they are stale
+    
+    // frozen CSR layout: edges of node u with mode m are [edgeStart[u*NUM_MODES+m], edgeStart[u*NUM_MODES+m+1])
+    bool frozen = false;
+    vector<int> edgeStart;
+    vector<int> edgeTo;
+    vector<Weight> edgeDist;
+    
+    // exactness guard (COMPACT_GRAPH only): exact lengths of the slots whose length the
+    // coordinates do not reproduce, and the number of coordinates rounded on loading
+    unordered_map<int,double> exactDist;
+    long long roundedCoords = 0;
+    
+    // stop names: each distinct name is stored once, and only named nodes have an entry
+    vector<string> names;
+    unordered_map<string,int> nameIds;
+    unordered_map<int,int> nodeNames;
     
-    int addNode(double lat, double lon, string name = "", bool isStop = false) {
-        long long key = makeKey(lat, lon);
-        if (nodeMap.find(key) == nodeMap.end()) {
-            nodeMap[key] = nodeCount++;
-            nodes.push_back({lat, lon, "", isStop});
+    // live changes (see closeEdge): target of every closed slot, and the loaded length
+    // of every slot whose length was scaled
+    unordered_map<int,int> closedTo;
+    unordered_map<int,double> loadedLength;
+    
+    // snapping index: one grid over all nodes, one per mode over nodes touching that mode
+    SpatialGrid grid;
+    SpatialGrid modeGrid[NUM_MODES];
+    bool indexDirty = true;
+    
+    int addNode(double lat, double lon, const string& name = "", bool isStop = false) {
+        bool inserted;
+        int id = nodeMap.findOrInsert(makeKey(lat, lon), nodeCount, inserted);
+        if (inserted) {
+            nodeCount++;
+            nodes.push_back(makeNode(lat, lon, isStop));
             adj.push_back(vector<Edge>());
+            indexDirty = true;
+            revision++;
         }
-        int id = nodeMap[key];
-        if (!name.empty()) nodes[id].name = name;
+        if (!name.empty()) setNodeName(id, name);
         if (isStop) nodes[id].isStop = true;
         return id;
     }
     
+    // name of a node, empty for an unnamed one
+    const string& nodeName(int u) const {
+        static const string none;
+        auto it = nodeNames.find(u);
+        return it == nodeNames.end() ? none : names[it->second];
+    }
+    
+    void setNodeName(int u, const string& name) {
+        auto it = nameIds.emplace(name, (int)names.size()).first;
+        if (it->second == (int)names.size()) names.push_back(name);
+        nodeNames[u] = it->second;
+    }
+    
+    // bulk dedup of many unnamed points in one hashing pass: the index is pre-sized from
+    // the batch (consecutive road segments share about half their points) and new nodes
+    // are numbered in first-occurrence order, so ids match calling addNode on each point
+    vector<int> addNodesBulk(const vector<pair<double,double>>& coords) {
+        vector<int> ids(coords.size());
+        nodeMap.reserve(nodeMap.size() + coords.size() / 2);
+        int before = nodeCount;
+        for (size_t i = 0; i < coords.size(); i++) {
+            bool inserted;
+            ids[i] = nodeMap.findOrInsert(makeKey(coords[i].first, coords[i].second), nodeCount, inserted);
+            if (inserted) {
+                nodeCount++;
+                nodes.push_back(makeNode(coords[i].first, coords[i].second, false));
+            }
+        }
+        adj.resize(nodeCount);
+        if (nodeCount != before) {
+            indexDirty = true;
+            revision++;
+        }
+        return ids;
+    }
+    
     void addEdge(int u, int v, double dist, int mode) {
         adj[u].push_back({v, dist, mode});
         adj[v].push_back({u, dist, mode});
+        indexDirty = true;
+        revision++;
+    }
+    
+    // convert adj into the CSR arrays and release it; call once loading is done
+    void freeze() {
+        if (frozen) return;
+        edgeStart.assign((size_t)nodeCount * NUM_MODES + 1, 0);
+        for (int u = 0; u < nodeCount; u++) {
+            for (auto& e : adj[u]) edgeStart[u * NUM_MODES + e.mode + 1]++;
+        }
+        for (size_t i = 0; i + 1 < edgeStart.size(); i++) edgeStart[i + 1] += edgeStart[i];
+        
+        int m = edgeStart.back();
+        edgeTo.resize(m);
+        edgeDist.resize(m);
+        exactDist.clear();
+        vector<int> fill(edgeStart.begin(), edgeStart.end() - 1);
+        for (int u = 0; u < nodeCount; u++) {
+            for (auto& e : adj[u]) {
+                int slot = fill[u * NUM_MODES + e.mode]++;
+                edgeTo[slot] = e.to;
+                setLength(u, slot, e.dist);
+            }
+        }
+        
+        vector<vector<Edge>>().swap(adj);
+        frozen = true;
+        revision++;
     }
     
-    int getNearestNode(double lat, double lon, double &minDist) {
-        minDist = INF;
-        int nearest = -1;
+    // edge range of u restricted to one mode (frozen graphs only)
+    int edgeBegin(int u, int mode) const { return edgeStart[u * NUM_MODES + mode]; }
+    int edgeEnd(int u, int mode) const { return edgeStart[u * NUM_MODES + mode + 1]; }
+    
+    // mode of slot i, one of u's edges
+    int edgeModeAt(int u, int i) const {
+        int m = 0;
+        while (m + 1 < NUM_MODES && i >= edgeEnd(u, m)) m++;
+        return m;
+    }
+    
+    // length of slot i, one of u's edges, as it was loaded
+    double exactLength([[maybe_unused]] int u, int i) const {
+#ifdef COMPACT_GRAPH
+        auto it = exactDist.find(i);
+        if (it != exactDist.end()) return it->second;
+        int v = edgeTo[i];
+        return haversine(nodes[u].lat, nodes[u].lon, nodes[v].lat, nodes[v].lon);
+#else
+        return edgeDist[i];
+#endif
+    }
+    
+    // store the length of slot i, one of u's edges; the guard keeps it if the
+    // coordinates would not give it back
+    void setLength([[maybe_unused]] int u, int i, double dist) {
+        edgeDist[i] = (Weight)dist;
+#ifdef COMPACT_GRAPH
+        int v = edgeTo[i];
+        if (haversine(nodes[u].lat, nodes[u].lon, nodes[v].lat, nodes[v].lon) != dist) exactDist[i] = dist;
+        else if (!exactDist.empty()) exactDist.erase(i);
+#endif
+    }
+    
+    // length of the shortest u-v edge with one mode, INF if there is none (frozen graphs
+    // only); this is what the searches add for that step, or with COMPACT_GRAPH the exact
+    // length of the float they add
+    double edgeLength(int u, int v, int mode) const {
+        double d = INF;
+        for (int i = edgeBegin(u, mode); i < edgeEnd(u, mode); i++) {
+            if (edgeTo[i] == v) d = min(d, exactLength(u, i));
+        }
+        return d;
+    }
+    
+    // Live changes to a frozen graph. Each one applies to every u-v edge of the mode in
+    // both directions and returns the number of slots it changed. A closed slot points
+    // back at its own node: every search and builder already skips or never gains from a
+    // self loop, so only snapping has to know about closures (closedOff). It keeps its
+    // length, and its target in closedTo until it is reopened.
+    int closeEdge(int u, int v, int mode) {
+        return changeSlots(u, v, mode, false, [&](int a, int b, int i) {
+            double len = exactLength(a, i);
+            closedTo[i] = b;
+            edgeTo[i] = a;
+            setLength(a, i, len);
+        });
+    }
+    
+    int reopenEdge(int u, int v, int mode) {
+        return changeSlots(u, v, mode, true, [&](int a, int b, int i) {
+            double len = exactLength(a, i);
+            closedTo.erase(i);
+            edgeTo[i] = b;
+            setLength(a, i, len);
+        });
+    }
+    
+    // set the length of the u-v edges, open or closed, to factor times their loaded
+    // length; factor 1 restores them. Factors below 1 would make an edge shorter than
+    // the straight line the A* bounds assume, so callers keep factor >= 1.
+    int scaleEdge(int u, int v, int mode, double factor) {
+        int n = 0;
+        for (bool closed : {false, true}) {
+            n += changeSlots(u, v, mode, closed, [&](int a, int, int i) {
+                auto it = loadedLength.emplace(i, exactLength(a, i)).first;
+                setLength(a, i, it->second * factor);
+                if (factor == 1) loadedLength.erase(it);
+            });
+        }
+        return n;
+    }
+    
+    // bitmask of the modes that have at least one edge at u
+    int nodeModes(int u) const {
+        int mask = 0;
+        if (frozen) {
+            for (int m = 0; m < NUM_MODES; m++) {
+                if (edgeBegin(u, m) < edgeEnd(u, m)) mask |= modeBit(m);
+            }
+        } else {
+            for (auto& e : adj[u]) mask |= modeBit(e.mode);
+        }
+        return mask;
+    }
+    
+    // true if u has edges with the modes of mask and all of them are closed; such a
+    // node stays in the snapping grids, which closures do not touch, and is skipped
+    bool closedOff(int u, int mask) const {
+        if (closedTo.empty()) return false;
+        bool closed = false;
+        for (int m = 0; m < NUM_MODES; m++) {
+            if (!(mask & modeBit(m))) continue;
+            for (int i = edgeBegin(u, m); i < edgeEnd(u, m); i++) {
+                if (edgeTo[i] != u) return false;
+                closed = closed || closedTo.count(i);
+            }
+        }
+        return closed;
+    }
+    
+    // build the snapping grids; called lazily by the nearest-node queries
+    void buildSpatialIndex() {
+        vector<int> all(nodeCount);
+        vector<int> byMode[NUM_MODES];
         for (int i = 0; i < nodeCount; i++) {
-            double d = haversine(lat, lon, nodes[i].lat, nodes[i].lon);
-            if (d < minDist) {
-                minDist = d;
-                nearest = i;
+            all[i] = i;
+            int mask = nodeModes(i);
+            for (int m = 0; m < NUM_MODES; m++) {
+                if (mask & modeBit(m)) byMode[m].push_back(i);
+            }
+        }
+        grid.build(nodes, all);
+        for (int m = 0; m < NUM_MODES; m++) modeGrid[m].build(nodes, byMode[m]);
+        indexDirty = false;
+    }
+    
+    // k nearest nodes as {distance km, id}; modeMask restricts to nodes with an edge of those
+    // modes, and nodes whose edges of those modes are all closed are left out
+    vector<pair<double,int>> getNearestNodes(double lat, double lon, int k, int modeMask = ALL_MODES) {
+        if (indexDirty) buildSpatialIndex();
+        vector<pair<double,int>> result;
+        if (modeMask == ALL_MODES) {
+            if (closedTo.empty()) grid.nearest(lat, lon, k, result);
+            else grid.nearest(lat, lon, k, result, [&](int u) { return !closedOff(u, ALL_MODES); });
+            return result;
+        }
+        
+        vector<pair<double,int>> part;
+        for (int m = 0; m < NUM_MODES; m++) {
+            if (!(modeMask & modeBit(m))) continue;
+            if (closedTo.empty()) modeGrid[m].nearest(lat, lon, k, part);
+            else modeGrid[m].nearest(lat, lon, k, part, [&](int u) { return !closedOff(u, modeBit(m)); });
+            result.insert(result.end(), part.begin(), part.end());
+        }
+        sort(result.begin(), result.end());
+        result.erase(unique(result.begin(), result.end()), result.end());
+        if ((int)result.size() > k) result.resize(k);
+        return result;
+    }
+    
+    int getNearestNode(double lat, double lon, double &minDist, int modeMask = ALL_MODES) {
+        vector<pair<double,int>> best = getNearestNodes(lat, lon, 1, modeMask);
+        if (best.empty()) {
+            minDist = INF;
+            return -1;
+        }
+        minDist = best[0].first;
+        return best[0].second;
+    }
+
+private:
+    // fn(a, b, slot) for the slots of the mode from u to v and from v to u, open ones or
+    // closed ones
+    template <class Fn>
+    int changeSlots(int u, int v, int mode, bool closed, Fn fn) {
+        if (!frozen || u == v) return 0;
+        int n = 0;
+        for (auto [a, b] : {make_pair(u, v), make_pair(v, u)}) {
+            for (int i = edgeBegin(a, mode); i < edgeEnd(a, mode); i++) {
+                auto it = closedTo.find(i);
+                bool isClosed = it != closedTo.end();
+                if (isClosed != closed || (isClosed ? it->second : edgeTo[i]) != b) continue;
+                fn(a, b, i);
+                n++;
             }
         }
-        return nearest;
+        if (n > 0) revision++;
+        return n;
+    }
+    
+    Node makeNode(double lat, double lon, bool isStop) {
+        Node node = {lat, lon, isStop};
+        if (node.lat != lat || node.lon != lon) roundedCoords++;
+        return node;
     }
 };
 
@@ -109,58 +622,125 @@ inline string trim(string s) {
     return s.substr(start, end - start + 1);
 }
 
-// load road map
-inline void loadRoads(Graph& graph, string filename) {
-    ifstream file(filename);
-    string line;
-    while (getline(file, line)) {
-        vector<string> parts = parseCSV(line);
-        if (parts.size() < 6) continue;
-        
-        vector<pair<double,double>> coords;
-        for (int i = 1; i < (int)parts.size() - 2; i += 2) {
-            try {
-                double lon = stod(parts[i]);
-                double lat = stod(parts[i+1]);
-                coords.push_back({lat, lon});
-            } catch (...) {
-                break;
+// read-only memory mapping of a whole file; empty view if it cannot be opened
+struct MappedFile {
+    const char* data = nullptr;
+    size_t size = 0;
+    
+    explicit MappedFile(const string& filename) {
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                data = (const char*)p;
+                size = st.st_size;
+                madvise(p, size, MADV_SEQUENTIAL);
             }
         }
+        close(fd);
+    }
+    ~MappedFile() { if (data) munmap((void*)data, size); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    
+    string_view view() const { return string_view(data ? data : "", size); }
+};
+
+// split one line on ',' into views, with the same fields getline() would produce
+// (no trailing empty field); fields is reused between lines to avoid allocation
+inline void splitCSV(string_view line, vector<string_view>& fields) {
+    fields.clear();
+    size_t pos = 0;
+    while (pos < line.size()) {
+        size_t comma = line.find(',', pos);
+        if (comma == string_view::npos) comma = line.size();
+        fields.push_back(line.substr(pos, comma - pos));
+        pos = comma + 1;
+    }
+}
+
+inline string_view trimView(string_view s) {
+    size_t start = s.find_first_not_of(" \t\r\n");
+    if (start == string_view::npos) return string_view();
+    size_t end = s.find_last_not_of(" \t\r\n");
+    return s.substr(start, end - start + 1);
+}
+
+// parse a double like stod: leading whitespace allowed, trailing junk ignored
+inline bool parseDouble(string_view s, double& value) {
+    size_t i = 0;
+    while (i < s.size() && isspace((unsigned char)s[i])) i++;
+    auto res = from_chars(s.data() + i, s.data() + s.size(), value);
+    return res.ec == errc();
+}
+
+// walk the lines of a mapped file; fn(string_view line) without the '\n'
+template <class Fn>
+inline void forEachLine(string_view text, Fn fn) {
+    size_t pos = 0;
+    while (pos < text.size()) {
+        const char* nl = (const char*)memchr(text.data() + pos, '\n', text.size() - pos);
+        size_t end = nl ? nl - text.data() : text.size();
+        fn(text.substr(pos, end - pos));
+        pos = end + 1;
+    }
+}
+
+// lon,lat pairs from fields[1] up to (not including) the last two fields
+inline void parseCoords(const vector<string_view>& parts, vector<pair<double,double>>& coords) {
+    coords.clear();
+    for (int i = 1; i < (int)parts.size() - 2; i += 2) {
+        double lon, lat;
+        if (!parseDouble(parts[i], lon) || !parseDouble(parts[i+1], lat)) break;
+        coords.push_back({lat, lon});
+    }
+}
+
+// load road map: parse every segment first, then dedup all points in one bulk pass
+inline void loadRoads(Graph& graph, string filename) {
+    MappedFile file(filename);
+    vector<string_view> parts;
+    vector<pair<double,double>> coords, points;
+    vector<size_t> lineStart;
+    forEachLine(file.view(), [&](string_view line) {
+        splitCSV(line, parts);
+        if (parts.size() < 6) return;
+        
+        parseCoords(parts, coords);
+        if (coords.size() < 2) return;
         
-        for (int i = 0; i < (int)coords.size() - 1; i++) {
-            int n1 = graph.addNode(coords[i].first, coords[i].second);
-            int n2 = graph.addNode(coords[i+1].first, coords[i+1].second);
-            double dist = haversine(coords[i].first, coords[i].second, coords[i+1].first, coords[i+1].second);
-            graph.addEdge(n1, n2, dist, 0); // mode 0 = car
+        lineStart.push_back(points.size());
+        points.insert(points.end(), coords.begin(), coords.end());
+    });
+    lineStart.push_back(points.size());
+    
+    vector<int> ids = graph.addNodesBulk(points);
+    
+    for (size_t l = 0; l + 1 < lineStart.size(); l++) {
+        for (size_t i = lineStart[l]; i + 1 < lineStart[l + 1]; i++) {
+            double dist = haversine(points[i].first, points[i].second, points[i+1].first, points[i+1].second);
+            graph.addEdge(ids[i], ids[i+1], dist, 0); // mode 0 = car
         }
     }
-    file.close();
 }
 
 // load transport routes
 inline void loadTransport(Graph& graph, string filename, int mode) {
-    ifstream file(filename);
-    string line;
-    while (getline(file, line)) {
-        vector<string> parts = parseCSV(line);
-        if (parts.size() < 4) continue;
+    MappedFile file(filename);
+    vector<string_view> parts;
+    vector<pair<double,double>> coords;
+    forEachLine(file.view(), [&](string_view line) {
+        splitCSV(line, parts);
+        if (parts.size() < 4) return;
         
-        string startName = trim(parts[parts.size()-2]);
-        string endName = trim(parts[parts.size()-1]);
+        string startName(trimView(parts[parts.size()-2]));
+        string endName(trimView(parts[parts.size()-1]));
         
-        vector<pair<double,double>> coords;
-        for (int i = 1; i < (int)parts.size() - 2; i += 2) {
-            try {
-                double lon = stod(parts[i]);
-                double lat = stod(parts[i+1]);
-                coords.push_back({lat, lon});
-            } catch (...) {
-                break;
-            }
-        }
+        parseCoords(parts, coords);
         
-        if (coords.size() < 2) continue;
+        if (coords.size() < 2) return;
         
         int startNode = graph.addNode(coords[0].first, coords[0].second, startName, true);
         int endNode = graph.addNode(coords.back().first, coords.back().second, endName, true);
@@ -175,32 +755,7 @@ inline void loadTransport(Graph& graph, string filename, int mode) {
         
         double dist = haversine(graph.nodes[prevNode].lat, graph.nodes[prevNode].lon, coords.back().first, coords.back().second);
         graph.addEdge(prevNode, endNode, dist, mode);
-    }
-    file.close();
-}
-
-// save KML file
-inline void saveKML(Graph& graph, vector<int>& path, string filename) {
-    ofstream file(filename);
-    file << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
-    file << "<kml xmlns=\"http://earth.google.com/kml/2.1\">\n";
-    file << "<Document>\n";
-    file << "<Placemark>\n";
-    file << "<name>" << filename << "</name>\n";
-    file << "<LineString>\n";
-    file << "<tessellate>1</tessellate>\n";
-    file << "<coordinates>\n";
-    
-    for (int id : path) {
-        file << fixed << setprecision(6) << graph.nodes[id].lon << "," << graph.nodes[id].lat << ",0\n";
-    }
-    
-    file << "</coordinates>\n";
-    file << "</LineString>\n";
-    file << "</Placemark>\n";
-    file << "</Document>\n";
-    file << "</kml>\n";
-    file.close();
+    });
 }
 
 // get mode name
@@ -212,9 +767,21 @@ inline string getModeName(int mode) {
     return "Unknown";
 }
 
+// mode whose name starts with the given word, ignoring case ("car", "metro", "bikalpa", "uttara"), -1 if none
+inline int modeByName(string word) {
+    transform(word.begin(), word.end(), word.begin(), ::tolower);
+    for (int m = 0; m < NUM_MODES; m++) {
+        string name = getModeName(m);
+        name = name.substr(0, name.find(' '));
+        transform(name.begin(), name.end(), name.begin(), ::tolower);
+        if (word == name) return m;
+    }
+    return -1;
+}
+
 // get node name or coords
-inline string getNodeName(Graph& graph, int id) {
-    if (!graph.nodes[id].name.empty()) return graph.nodes[id].name;
+inline string getNodeName(const Graph& graph, int id) {
+    if (!graph.nodeName(id).empty()) return graph.nodeName(id);
     stringstream ss;
     ss << fixed << setprecision(6) << "(" << graph.nodes[id].lat << ", " << graph.nodes[id].lon << ")";
     return ss.str();
@@ -247,6 +814,20 @@ inline string minsToTime(int mins) {
     return ss.str();
 }
 
+// fractional minutes as a clock time with seconds
+inline string minsToClock(double mins) {
+    long long secs = llround(mins * 60);
+    int h = (int)(secs / 3600 % 24);
+    int m = (int)(secs / 60 % 60);
+    string period = (h < 12) ? "AM" : "PM";
+    h = h % 12;
+    if (h == 0) h = 12;
+    
+    stringstream ss;
+    ss << h << ":" << setfill('0') << setw(2) << m << ":" << setw(2) << secs % 60 << " " << period;
+    return ss.str();
+}
+
 inline int nextDeparture(int currMins, int interval, int startMins, int endMins) {
     if (currMins < startMins) return startMins;
     if (currMins > endMins) return -1;
@@ -0,0 +1,167 @@
+#ifndef HEAP_H
+#define HEAP_H
+
+#include "graph.h"
+
+// Priority queues of nodes for the Dijkstra-style searches, picked per search through
+// SearchWorkspace::queue. All of them pop (key, node) in increasing key order.
+//
+//   QUEUE_BINARY  binary heap with lazy deletion: a better key is pushed as a new entry
+//                 and the old one is skipped when it comes up (the default)
+//   QUEUE_QUAD    indexed 4-ary heap with decrease-key: one entry per node, so no stale
+//                 entries and a shallower tree
+//   QUEUE_RADIX   monotone radix heap: keys must never fall below the last key popped,
+//                 which holds for Dijkstra and for A* with a consistent bound. Integer
+//                 minutes are exact; non-negative doubles sort like their bit patterns
+//                 read as unsigned integers, so cost keys work too
+//
+// Equal keys come out in node order from the two heaps and in any order from the radix
+// heap, so routes of equal cost may differ between queues; costs never do.
+
+enum QueueKind { QUEUE_BINARY, QUEUE_QUAD, QUEUE_RADIX };
+
+inline const char* queueName(int queue) {
+    if (queue == QUEUE_QUAD) return "quad";
+    if (queue == QUEUE_RADIX) return "radix";
+    return "binary";
+}
+
+struct QuadHeap {
+    vector<pair<double,int>> items;
+    vector<int> pos; // index of each node in items, -1 if it is not in the heap
+    
+    // empty heap for nodes 0..n-1
+    void clear(int n) {
+        // the items left over may be states of a larger search than the next one
+        for (auto& [k, v] : items) pos[v] = -1;
+        items.clear();
+        if ((int)pos.size() != n) pos.assign(n, -1);
+    }
+    
+    bool empty() const { return items.empty(); }
+    const pair<double,int>& top() const { return items[0]; }
+    
+    // insert v, or lower its key if it is already in the heap with a larger one
+    void push(double key, int v) {
+        int i = pos[v];
+        if (i < 0) {
+            i = items.size();
+            items.push_back({key, v});
+        } else if (key < items[i].first) {
+            items[i].first = key;
+        } else {
+            return;
+        }
+        siftUp(i);
+    }
+    
+    pair<double,int> pop() {
+        pair<double,int> top = items[0];
+        pos[top.second] = -1;
+        pair<double,int> last = items.back();
+        items.pop_back();
+        if (!items.empty()) {
+            items[0] = last;
+            pos[last.second] = 0;
+            siftDown(0);
+        }
+        return top;
+    }
+
+private:
+    void place(int i, const pair<double,int>& item) {
+        items[i] = item;
+        pos[item.second] = i;
+    }
+    
+    void siftUp(int i) {
+        pair<double,int> item = items[i];
+        while (i > 0) {
+            int parent = (i - 1) / 4;
+            if (!(item < items[parent])) break;
+            place(i, items[parent]);
+            i = parent;
+        }
+        place(i, item);
+    }
+    
+    void siftDown(int i) {
+        pair<double,int> item = items[i];
+        int n = items.size();
+        while (true) {
+            int first = 4 * i + 1;
+            if (first >= n) break;
+            int best = first;
+            for (int c = first + 1; c < min(first + 4, n); c++) {
+                if (items[c] < items[best]) best = c;
+            }
+            if (!(items[best] < item)) break;
+            place(i, items[best]);
+            i = best;
+        }
+        place(i, item);
+    }
+};
+
+struct RadixHeap {
+    // bucket 0 holds keys equal to last, bucket b keys whose highest bit differing from
+    // last is bit b - 1; entries keep their own key, last only decides the bucket
+    vector<pair<uint64_t,int>> buckets[65];
+    uint64_t last = 0;
+    size_t count = 0;
+    
+    static uint64_t bits(double key) {
+        key = max(key, 0.0);
+        uint64_t k;
+        memcpy(&k, &key, sizeof(k));
+        return k;
+    }
+    static double value(uint64_t k) {
+        double key;
+        memcpy(&key, &k, sizeof(key));
+        return key;
+    }
+    // a key below last (rounding in an A* bound) is filed with last
+    int bucketOf(uint64_t k) const { return k <= last ? 0 : 64 - __builtin_clzll(k ^ last); }
+    
+    void clear() {
+        for (auto& b : buckets) b.clear();
+        last = 0;
+        count = 0;
+    }
+    
+    bool empty() const { return count == 0; }
+    
+    void push(double key, int v) {
+        uint64_t k = bits(key);
+        buckets[bucketOf(k)].push_back({k, v});
+        count++;
+    }
+    
+    // smallest key; moves the entries of the first non-empty bucket down first
+    pair<double,int> top() {
+        refill();
+        return {value(buckets[0].back().first), buckets[0].back().second};
+    }
+    
+    pair<double,int> pop() {
+        pair<double,int> t = top();
+        buckets[0].pop_back();
+        count--;
+        return t;
+    }
+
+private:
+    void refill() {
+        if (!buckets[0].empty()) return;
+        int b = 1;
+        while (buckets[b].empty()) b++;
+        uint64_t least = buckets[b][0].first;
+        for (auto& e : buckets[b]) least = min(least, e.first);
+        last = max(last, least);
+        for (auto& e : buckets[b]) buckets[bucketOf(e.first)].push_back(e);
+        buckets[b].clear();
+    }
+};
+
+#endif // HEAP_H
@@ -0,0 +1,151 @@
+#ifndef ISOCHRONE_H
+#define ISOCHRONE_H
+
+#include "routing.h"
+
+// Isochrones: every node reachable from a source within a budget of minutes or taka,
+// with the edge times and schedules of the timed searches (edgeTimes).
+//
+// One Dijkstra from the source on elapsed minutes (or on cost) that never pushes a node
+// past the budget, so it stops by itself at the edge of the reachable area. Waiting for
+// a departure never makes a later arrival earlier, so the minutes are the earliest
+// arrivals of fastestRoute; by cost it keeps one label per node like cheapestWithTime.
+// The workspace is reused, so a batch (one isochrone per metro station) costs only the
+// searches themselves.
+
+struct Isochrone {
+    int source = -1;
+    int startMins = 0;
+    bool byCost = false;  // budget in Tk instead of minutes
+    double budget = 0;
+    vector<int> nodes;    // reached nodes in the order the search settled them
+    vector<int> times;    // arrival minute at each
+    vector<double> costs; // Tk paid to get there
+    
+    // what the budget is spent on for the k-th reached node
+    double used(size_t k) const { return byCost ? costs[k] : times[k] - startMins; }
+};
+
+// ws.dist holds the searched quantity (minutes since startMins or cost), ws.pot the other
+// one (cost or arrival minute) of the same label
+inline Isochrone isochrone(const Graph& graph, int source, int startMins, double budget, bool byCost,
+                           const double costPerKm[], const double speeds[], const int intervals[],
+                           const int schedStart[], const int schedEnd[], const bool allowed[], SearchWorkspace& ws) {
+    Isochrone iso;
+    iso.source = source;
+    iso.startMins = startMins;
+    iso.byCost = byCost;
+    iso.budget = budget;
+    ws.reset(graph.nodeCount);
+    ws.set(source, 0, -1, 0);
+    ws.pot[source] = byCost ? startMins : 0;
+    ws.push(0, source);
+    
+    while (!ws.empty()) {
+        auto [k, u] = ws.pop();
+        if (k > ws.dist[u]) continue;
+        int time = byCost ? (int)ws.pot[u] : startMins + (int)k;
+        double cost = byCost ? k : ws.pot[u];
+        iso.nodes.push_back(u);
+        iso.times.push_back(time);
+        iso.costs.push_back(cost);
+        
+        for (int m = 0; m < NUM_MODES; m++) {
+            if (!allowed[m]) continue;
+            for (int i = graph.edgeBegin(u, m); i < graph.edgeEnd(u, m); i++) {
+                int v = graph.edgeTo[i];
+                int arriveTime;
+                if (!edgeTimes(m, graph.edgeDist[i], time, speeds, intervals, schedStart, schedEnd, arriveTime)) continue;
+                double newCost = cost + graph.edgeDist[i] * costPerKm[m];
+                double nk = byCost ? newCost : arriveTime - startMins;
+                if (nk > budget || nk >= ws.get(v)) continue;
+                ws.set(v, nk, u, m);
+                ws.pot[v] = byCost ? arriveTime : newCost;
+                ws.push(nk, v);
+            }
+        }
+    }
+    return iso;
+}
+
+// KML of an isochrone: the budget split into bands, each band drawn as the grid cells
+// (cellKm wide) whose best reached node falls in it, merged into one rectangle per run
+// of cells along a row, plus a point for every reached stop. A cell holds many nodes,
+// so the file stays small however many nodes the search reached.
+inline void saveIsochroneKML(const Graph& graph, const Isochrone& iso, string filename, int bands = 4,
+                             double cellKm = 0.25) {
+    const Node& src = graph.nodes[iso.source];
+    double dLat = cellKm / (EARTH_RADIUS * PI / 180);
+    double dLon = dLat / cos(src.lat * PI / 180);
+    map<pair<int,int>, double> cells; // {row, column} -> least budget used in the cell
+    for (size_t k = 0; k < iso.nodes.size(); k++) {
+        const Node& x = graph.nodes[iso.nodes[k]];
+        pair<int,int> cell = {(int)floor((x.lat - src.lat) / dLat), (int)floor((x.lon - src.lon) / dLon)};
+        auto it = cells.find(cell);
+        if (it == cells.end()) cells[cell] = iso.used(k);
+        else it->second = min(it->second, iso.used(k));
+    }
+    auto bandOf = [&](double used) {
+        return iso.budget > 0 ? max(0, min(bands - 1, (int)ceil(used / iso.budget * bands - 1e-9) - 1)) : 0;
+    };
+    auto limit = [&](int b) {
+        stringstream ss;
+        double v = iso.budget * (b + 1) / bands;
+        if (iso.byCost) ss << "up to Tk " << fixed << setprecision(2) << v;
+        else ss << "up to " << v << " min";
+        return ss.str();
+    };
+    
+    ofstream file(filename);
+    file << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+    file << "<kml xmlns=\"http://earth.google.com/kml/2.1\">\n";
+    file << "<Document>\n";
+    file << "<name>" << filename << "</name>\n";
+    // green for the nearest band to red for the farthest, half transparent (aabbggrr)
+    for (int b = 0; b < bands; b++) {
+        int red = bands > 1 ? 255 * b / (bands - 1) : 0;
+        file << "<Style id=\"band" << b << "\"><LineStyle><width>0</width></LineStyle><PolyStyle><color>7f00"
+             << hex << setfill('0') << setw(2) << 255 - red << setw(2) << red << dec << setfill(' ')
+             << "</color></PolyStyle></Style>\n";
+    }
+    file << fixed << setprecision(6);
+    
+    for (int b = 0; b < bands; b++) {
+        file << "<Placemark>\n";
+        file << "<name>" << limit(b) << "</name>\n";
+        file << "<styleUrl>#band" << b << "</styleUrl>\n";
+        file << "<MultiGeometry>\n";
+        for (auto it = cells.begin(); it != cells.end();) {
+            if (bandOf(it->second) != b) {
+                ++it;
+                continue;
+            }
+            auto [row, first] = it->first;
+            int last = first;
+            for (++it; it != cells.end() && it->first == make_pair(row, last + 1) && bandOf(it->second) == b; ++it) last++;
+            double lat0 = src.lat + row * dLat, lat1 = lat0 + dLat;
+            double lon0 = src.lon + first * dLon, lon1 = src.lon + (last + 1) * dLon;
+            file << "<Polygon><outerBoundaryIs><LinearRing><coordinates>" << lon0 << "," << lat0 << ",0 " << lon1 << ","
+                 << lat0 << ",0 " << lon1 << "," << lat1 << ",0 " << lon0 << "," << lat1 << ",0 " << lon0 << "," << lat0
+                 << ",0</coordinates></LinearRing></outerBoundaryIs></Polygon>\n";
+        }
+        file << "</MultiGeometry>\n";
+        file << "</Placemark>\n";
+    }
+    
+    for (size_t k = 0; k < iso.nodes.size(); k++) {
+        const Node& x = graph.nodes[iso.nodes[k]];
+        if (!x.isStop && k > 0) continue;
+        file << "<Placemark>\n";
+        file << "<name>" << getNodeName(graph, iso.nodes[k]) << "</name>\n";
+        file << "<description>" << minsToTime(iso.times[k]) << ", Tk " << setprecision(2) << iso.costs[k]
+             << setprecision(6) << "</description>\n";
+        file << "<Point><coordinates>" << x.lon << "," << x.lat << ",0</coordinates></Point>\n";
+        file << "</Placemark>\n";
+    }
+    file << "</Document>\n";
+    file << "</kml>\n";
+    file.close();
+}
+
+#endif // ISOCHRONE_H
@@ -0,0 +1,231 @@
+#ifndef MATRIX_H
+#define MATRIX_H
+
+#include "ch.h"
+#include "snapshot.h"
+#include <thread>
+#include <atomic>
+
+// Cost matrices between a list of source nodes and a list of target nodes.
+//
+// costMatrix runs one Dijkstra per source with the costs of cheapestRoute and reads
+// every target off its tree, stopping once all of them are settled. chMatrix answers
+// car distances with the contraction hierarchy in two passes: an upward search from
+// every target leaves {target, distance} in a bucket at each node it settles, then an
+// upward search from a source meets every target at once by scanning the buckets of
+// the nodes it settles. Edges are undirected, so both passes climb the same edges.
+// Sources (and targets for the buckets) are spread over threads, each with its own
+// workspace.
+
+struct CostMatrix {
+    vector<int> sources, targets;
+    vector<double> cost; // row-major, sources x targets, -1 where there is no route
+    long long settled = 0;
+    
+    int rows() const { return sources.size(); }
+    int cols() const { return targets.size(); }
+    double at(int i, int j) const { return cost[(size_t)i * targets.size() + j]; }
+};
+
+// run job(i, ws) for i in [0, count) on threads workers, each with its own workspace
+template <class Fn>
+inline void forEachParallel(int count, int threads, Fn job) {
+    if (threads <= 0) threads = max(1, (int)thread::hardware_concurrency());
+    threads = max(1, min(threads, count));
+    atomic<int> next(0);
+    auto worker = [&]() {
+        SearchWorkspace ws;
+        for (int i = next++; i < count; i = next++) job(i, ws);
+    };
+    vector<thread> pool;
+    for (int t = 1; t < threads; t++) pool.emplace_back(worker);
+    worker();
+    for (auto& th : pool) th.join();
+}
+
+// one Dijkstra from source with the cheapestRoute costs, writing the cost of every
+// target to row (-1 if unreachable); stops once all remaining targets are settled
+inline int oneToMany(const Graph& graph, int source, const vector<int>& targets, const vector<char>& isTarget,
+                     int distinctTargets, const double costPerKm[], const bool allowed[], SearchWorkspace& ws,
+                     double* row) {
+    ws.reset(graph.nodeCount);
+    ws.set(source, 0, -1, 0);
+    ws.push(0, source);
+    int settled = 0, left = distinctTargets;
+    while (!ws.empty() && left > 0) {
+        auto [c, u] = ws.pop();
+        if (c > ws.dist[u]) continue;
+        settled++;
+        if (isTarget[u]) left--;
+        
+        for (int m = 0; m < NUM_MODES; m++) {
+            if (!allowed[m]) continue;
+            for (int i = graph.edgeBegin(u, m); i < graph.edgeEnd(u, m); i++) {
+                int v = graph.edgeTo[i];
+                double newCost = c + graph.edgeDist[i] * costPerKm[m];
+                if (newCost < ws.get(v)) {
+                    ws.set(v, newCost, u, m);
+                    ws.push(newCost, v);
+                }
+            }
+        }
+    }
+    for (size_t j = 0; j < targets.size(); j++) {
+        double c = ws.get(targets[j]);
+        row[j] = c < INF ? c : -1;
+    }
+    return settled;
+}
+
+inline CostMatrix costMatrix(const Graph& graph, const vector<int>& sources, const vector<int>& targets,
+                             const double costPerKm[], const bool allowed[], int threads = 0) {
+    CostMatrix mat;
+    mat.sources = sources;
+    mat.targets = targets;
+    mat.cost.assign(sources.size() * targets.size(), -1);
+    vector<char> isTarget(graph.nodeCount, 0);
+    int distinct = 0;
+    for (int t : targets) {
+        distinct += !isTarget[t];
+        isTarget[t] = 1;
+    }
+    
+    atomic<long long> settled(0);
+    forEachParallel(sources.size(), threads, [&](int i, SearchWorkspace& ws) {
+        settled += oneToMany(graph, sources[i], targets, isTarget, distinct, costPerKm, allowed, ws,
+                             &mat.cost[(size_t)i * targets.size()]);
+    });
+    mat.settled = settled;
+    return mat;
+}
+
+// upward search in the hierarchy from s, calling visit(node, distance) for every node it settles
+template <class Fn>
+inline int upwardSearch(const ContractionHierarchy& ch, int s, SearchWorkspace& ws, Fn visit) {
+    ws.reset(ch.nodeCount);
+    ws.set(s, 0, -1, 0);
+    ws.push(0, s);
+    int settled = 0;
+    while (!ws.empty()) {
+        auto [d, u] = ws.pop();
+        if (d > ws.dist[u]) continue;
+        settled++;
+        visit(u, d);
+        for (int i = ch.upStart[u]; i < ch.upStart[u + 1]; i++) {
+            int v = ch.upTo[i];
+            double nd = d + ch.upWeight[i];
+            if (nd < ws.get(v)) {
+                ws.set(v, nd, u, 0);
+                ws.push(nd, v);
+            }
+        }
+    }
+    return settled;
+}
+
+// car distance (km) between every source and target, many-to-many with buckets
+inline CostMatrix chMatrix(const ContractionHierarchy& ch, const vector<int>& sources, const vector<int>& targets,
+                           int threads = 0) {
+    CostMatrix mat;
+    mat.sources = sources;
+    mat.targets = targets;
+    mat.cost.assign(sources.size() * targets.size(), INF);
+    
+    // the target searches, each into its own list of {node, distance}
+    vector<vector<pair<int,double>>> reached(targets.size());
+    atomic<long long> settled(0);
+    forEachParallel(targets.size(), threads, [&](int j, SearchWorkspace& ws) {
+        settled += upwardSearch(ch, targets[j], ws, [&](int u, double d) { reached[j].push_back({u, d}); });
+    });
+    
+    // buckets in CSR form: the entries of node u are bucketTarget/bucketDist[bucketStart[u]..]
+    vector<int> bucketStart(ch.nodeCount + 1, 0);
+    for (auto& list : reached) {
+        for (auto& [u, d] : list) bucketStart[u + 1]++;
+    }
+    for (int u = 0; u < ch.nodeCount; u++) bucketStart[u + 1] += bucketStart[u];
+    vector<int> pos(bucketStart.begin(), bucketStart.end() - 1);
+    vector<int> bucketTarget(bucketStart[ch.nodeCount]);
+    vector<double> bucketDist(bucketStart[ch.nodeCount]);
+    for (size_t j = 0; j < reached.size(); j++) {
+        for (auto& [u, d] : reached[j]) {
+            bucketTarget[pos[u]] = j;
+            bucketDist[pos[u]++] = d;
+        }
+        vector<pair<int,double>>().swap(reached[j]);
+    }
+    
+    forEachParallel(sources.size(), threads, [&](int i, SearchWorkspace& ws) {
+        double* row = &mat.cost[(size_t)i * targets.size()];
+        settled += upwardSearch(ch, sources[i], ws, [&](int u, double d) {
+            for (int k = bucketStart[u]; k < bucketStart[u + 1]; k++) {
+                row[bucketTarget[k]] = min(row[bucketTarget[k]], d + bucketDist[k]);
+            }
+        });
+    });
+    for (double& c : mat.cost) {
+        if (c >= INF) c = -1;
+    }
+    mat.settled = settled;
+    return mat;
+}
+
+// CSV: a header row of target coordinates, then one row per source starting with its
+// coordinates; coordinates are "lon lat" like in query files, missing routes are empty
+inline bool saveMatrixCSV(const Graph& graph, const CostMatrix& mat, const string& filename) {
+    ofstream file(filename);
+    if (!file) return false;
+    file << fixed << setprecision(6) << "from\\to";
+    for (int t : mat.targets) file << "," << graph.nodes[t].lon << " " << graph.nodes[t].lat;
+    file << "\n";
+    for (int i = 0; i < mat.rows(); i++) {
+        file << setprecision(6) << graph.nodes[mat.sources[i]].lon << " " << graph.nodes[mat.sources[i]].lat
+             << setprecision(3);
+        for (int j = 0; j < mat.cols(); j++) {
+            file << ",";
+            if (mat.at(i, j) >= 0) file << mat.at(i, j);
+        }
+        file << "\n";
+    }
+    file.close();
+    return (bool)file;
+}
+
+const uint32_t MATRIX_VERSION = 1;
+
+struct MatrixHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    int32_t rows;
+    int32_t cols;
+};
+
+// binary: the header, then lon and lat of every source and every target as doubles,
+// then the rows x cols costs as doubles, row-major, -1 where there is no route
+inline bool saveMatrixBinary(const Graph& graph, const CostMatrix& mat, const string& filename) {
+    MatrixHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "GRPHMTRX", 8);
+    header.version = MATRIX_VERSION;
+    header.byteOrder = SNAPSHOT_BYTE_ORDER;
+    header.rows = mat.rows();
+    header.cols = mat.cols();
+    
+    vector<double> coords;
+    for (const vector<int>* list : {&mat.sources, &mat.targets}) {
+        for (int v : *list) {
+            coords.push_back(graph.nodes[v].lon);
+            coords.push_back(graph.nodes[v].lat);
+        }
+    }
+    ofstream file(filename, ios::binary);
+    if (!file) return false;
+    file.write((const char*)&header, sizeof(header));
+    file.write((const char*)coords.data(), coords.size() * sizeof(double));
+    file.write((const char*)mat.cost.data(), mat.cost.size() * sizeof(double));
+    file.close();
+    return (bool)file;
+}
+
+#endif // MATRIX_H
@@ -0,0 +1,152 @@
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include "graph.h"
+
+// Buffered route output. RouteWriter puts a whole document together in one reusable
+// buffer, formatting coordinates with to_chars, and writes it out in large blocks, so
+// thousands of routes cost little more than their bytes. A document holds any number
+// of routes, as KML placemarks or as GeoJSON LineString features (one per line), and
+// goes to a file or, for the name "-", to stdout.
+
+enum OutputFormat { FORMAT_KML, FORMAT_GEOJSON };
+
+class RouteWriter {
+public:
+    // title names the KML document; saveKML leaves it empty, which writes no name
+    RouteWriter(const string& filename, int format, const string& title = "") : format(format) {
+        if (filename != "-") {
+            file.open(filename);
+            out = &file;
+        }
+        if (format == FORMAT_GEOJSON) {
+            put("{\"type\": \"FeatureCollection\", \"features\": [\n");
+            return;
+        }
+        put("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+        put("<kml xmlns=\"http://earth.google.com/kml/2.1\">\n");
+        put("<Document>\n");
+        if (!title.empty()) {
+            put("<name>");
+            putEscaped(title);
+            put("</name>\n");
+        }
+    }
+    
+    ~RouteWriter() { close(); }
+    
+    RouteWriter(const RouteWriter&) = delete;
+    RouteWriter& operator=(const RouteWriter&) = delete;
+    
+    bool ok() const { return !out->fail(); }
+    int routes() const { return count; }
+    
+    // one route through the nodes of path; description is left out when empty
+    void addRoute(const Graph& graph, const vector<int>& path, const string& name, const string& description = "") {
+        STATS(StatTimer timer(PHASE_OUTPUT));
+        if (format == FORMAT_GEOJSON) {
+            put(count ? ",\n" : "");
+            put("{\"type\": \"Feature\", \"properties\": {\"name\": \"");
+            putEscaped(name);
+            if (!description.empty()) {
+                put("\", \"description\": \"");
+                putEscaped(description);
+            }
+            put("\"}, \"geometry\": {\"type\": \"LineString\", \"coordinates\": [");
+            for (size_t k = 0; k < path.size(); k++) {
+                put(k ? ", [" : "[");
+                putNumber(graph.nodes[path[k]].lon);
+                put(", ");
+                putNumber(graph.nodes[path[k]].lat);
+                put("]");
+            }
+            put("]}}");
+        } else {
+            put("<Placemark>\n<name>");
+            putEscaped(name);
+            put("</name>\n");
+            if (!description.empty()) {
+                put("<description>");
+                putEscaped(description);
+                put("</description>\n");
+            }
+            put("<LineString>\n<tessellate>1</tessellate>\n<coordinates>\n");
+            for (int id : path) {
+                putNumber(graph.nodes[id].lon);
+                put(",");
+                putNumber(graph.nodes[id].lat);
+                put(",0\n");
+            }
+            put("</coordinates>\n</LineString>\n</Placemark>\n");
+        }
+        count++;
+    }
+    
+    // finish the document and write out what is left; later calls do nothing
+    void close() {
+        if (closed) return;
+        closed = true;
+        put(format == FORMAT_GEOJSON ? (count ? "\n]}\n" : "]}\n") : "</Document>\n</kml>\n");
+        flush();
+        out->flush();
+        if (file.is_open()) file.close();
+    }
+
+private:
+    static const size_t FLUSH_BYTES = 1 << 16;
+    
+    ofstream file;
+    ostream* out = &cout;
+    string buf;
+    int format;
+    int count = 0;
+    bool closed = false;
+    
+    void flush() {
+        out->write(buf.data(), buf.size());
+        buf.clear();
+    }
+    
+    void put(string_view s) {
+        buf.append(s);
+        if (buf.size() >= FLUSH_BYTES) flush();
+    }
+    
+    // six decimals, as fixed << setprecision(6) prints them
+    void putNumber(double v) {
+        char tmp[64];
+        auto [end, ec] = to_chars(tmp, tmp + sizeof(tmp), v, chars_format::fixed, 6);
+        put(string_view(tmp, ec == errc() ? end - tmp : 0));
+    }
+    
+    // text as KML character data or a JSON string body
+    void putEscaped(string_view s) {
+        for (char c : s) {
+            if (format == FORMAT_KML) {
+                if (c == '&') put("&amp;");
+                else if (c == '<') put("&lt;");
+                else if (c == '>') put("&gt;");
+                else buf += c;
+            } else {
+                if (c == '"' || c == '\\') {
+                    buf += '\\';
+                    buf += c;
+                } else if ((unsigned char)c < 0x20) {
+                    char tmp[8];
+                    snprintf(tmp, sizeof(tmp), "\\u%04x", c);
+                    put(tmp);
+                } else {
+                    buf += c;
+                }
+            }
+        }
+    }
+};
+
+// save KML file with one route, named after the file
+inline void saveKML(const Graph& graph, const vector<int>& path, string filename) {
+    RouteWriter writer(filename, FORMAT_KML);
+    writer.addRoute(graph, path, filename);
+}
+
+#endif // OUTPUT_H
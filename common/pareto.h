@@ -0,0 +1,167 @@
+#ifndef PARETO_H
+#define PARETO_H
+
+#include "routing.h"
+
+// Multi-criteria label-setting search for the timed problems.
+//
+// cheapestWithTime and fastestRoute keep one label per node and rank by a single
+// criterion; cheapestWithDeadline answers one deadline. This search keeps every route
+// that no other beats in both arrival time and cost, with the same edge times
+// (edgeTimes) and costs, so its frontier at the destination answers all three: the
+// cheapest route is its last point, the fastest its first, and the cheapest by a
+// deadline the last point that arrives in time. Problems 4-6 and the router answer
+// from it; cheapestWithTime can miss the cheapest route, since a dearer label that
+// arrives earlier may catch a departure the cheaper one misses.
+//
+// Every edge takes at least a minute, so labels are kept in one bucket per arrival
+// minute and a bucket is complete when the search reaches it. It is sorted by cost
+// and expanded in order, so a label is dominated exactly when a label already taken
+// at its node costs no more; one cost per node is all the dominance test needs.
+//
+// Target pruning uses two searches back from the destination, ignoring schedules:
+// the least cost still to pay and the least minutes still to travel from each node.
+// A label is dropped once a route to the destination is known that arrives no later
+// than its earliest possible arrival and costs no more than its least possible cost.
+// Besides the routes found so far, the cheapest and the quickest route of those two
+// searches are timed with the schedules up front, so the search never looks past the
+// arrival of the cheapest route.
+
+struct ParetoResult {
+    vector<TimeResult> frontier; // by arrival time, each cheaper than the one before
+    int labels = 0;              // labels created
+    int settled = 0;             // labels taken from the buckets and expanded
+};
+
+// least cost (byTime false) or least travel minutes ignoring waits from every node to
+// end, with the next node on such a route in next / nextMode
+inline void costToGo(const Graph& graph, int end, const double costPerKm[], const double speeds[], const bool allowed[],
+                     bool byTime, vector<double>& dist, vector<int>& next, vector<int>& nextMode) {
+    dist.assign(graph.nodeCount, INF);
+    next.assign(graph.nodeCount, -1);
+    nextMode.assign(graph.nodeCount, 0);
+    priority_queue<pair<double,int>, vector<pair<double,int>>, greater<pair<double,int>>> pq;
+    dist[end] = 0;
+    pq.push({0, end});
+    while (!pq.empty()) {
+        auto [d, u] = pq.top();
+        pq.pop();
+        if (d > dist[u]) continue;
+        for (int m = 0; m < NUM_MODES; m++) {
+            if (!allowed[m]) continue;
+            for (int i = graph.edgeBegin(u, m); i < graph.edgeEnd(u, m); i++) {
+                int v = graph.edgeTo[i];
+                double w = graph.edgeDist[i] * costPerKm[m];
+                if (byTime) w = max(1, (int)((graph.edgeDist[i] / speeds[m]) * 60));
+                if (d + w < dist[v]) {
+                    dist[v] = d + w;
+                    next[v] = u;
+                    nextMode[v] = m;
+                    pq.push({dist[v], v});
+                }
+            }
+        }
+    }
+}
+
+inline ParetoResult paretoRoutes(const Graph& graph, int start, int end, int startMins,
+                                 const double costPerKm[], const double speeds[], const int intervals[],
+                                 const int schedStart[], const int schedEnd[], const bool allowed[],
+                                 int deadlineMins = INT_MAX) {
+    STATS(StatTimer timer(PHASE_SEARCH));
+    ParetoResult res;
+    vector<double> minCost, minTime;
+    vector<int> next, nextMode;
+    
+    // routes known up front: the cheapest and the quickest ignoring schedules, timed
+    vector<pair<int,double>> known; // {arrival, cost}
+    for (int byTime = 1; byTime >= 0; byTime--) {
+        vector<double>& bound = byTime ? minTime : minCost;
+        costToGo(graph, end, costPerKm, speeds, allowed, byTime, bound, next, nextMode);
+        if (bound[start] >= INF) return res;
+        int time = startMins;
+        double cost = 0;
+        bool ok = true;
+        for (int u = start; u != end && ok; u = next[u]) {
+            int m = nextMode[u];
+            double d = graph.edgeLength(u, next[u], m);
+            ok = edgeTimes(m, d, time, speeds, intervals, schedStart, schedEnd, time) && time <= deadlineMins;
+            cost += d * costPerKm[m];
+        }
+        if (ok) known.push_back({time, cost});
+    }
+    
+    LabelArena arena;
+    vector<double> bestCost(graph.nodeCount, INF); // cost of the last label taken at each node
+    vector<vector<int>> buckets(1);
+    // a known route beats everything a label can still become
+    auto beaten = [&](int time, double cost, int v) {
+        double t = time + minTime[v], c = cost + minCost[v] * ASTAR_SLACK;
+        if (bestCost[end] <= c) return true; // routes found so far arrive by time already
+        for (auto [kt, kc] : known) {
+            if (kt <= t && kc <= c && (kt < t || kc < c)) return true;
+        }
+        return false;
+    };
+    
+    buckets[0].push_back(arena.add(0, startMins, start, -1, 0));
+    res.labels = 1;
+    vector<int> bucket;
+    for (size_t b = 0; b < buckets.size(); b++) {
+        bucket.swap(buckets[b]);
+        buckets[b].clear();
+        stable_sort(bucket.begin(), bucket.end(), [&](int x, int y) { return arena.labels[x].cost < arena.labels[y].cost; });
+        for (int label : bucket) {
+            TimeLabel l = arena.labels[label];
+            if (l.cost >= bestCost[l.node] || beaten(l.time, l.cost, l.node)) {
+                STATS(statCount(STAT_STALE));
+                continue;
+            }
+            bestCost[l.node] = l.cost;
+            res.settled++;
+            STATS(statCount(STAT_SETTLED));
+            if (l.node == end) {
+                res.frontier.push_back(arena.result(label));
+                continue;
+            }
+            
+            for (int m = 0; m < NUM_MODES; m++) {
+                if (!allowed[m]) continue;
+                STATS(statCount(STAT_RELAXED, graph.edgeEnd(l.node, m) - graph.edgeBegin(l.node, m)));
+                for (int i = graph.edgeBegin(l.node, m); i < graph.edgeEnd(l.node, m); i++) {
+                    int v = graph.edgeTo[i];
+                    int arriveTime;
+                    if (!edgeTimes(m, graph.edgeDist[i], l.time, speeds, intervals, schedStart, schedEnd, arriveTime)) continue;
+                    if (arriveTime > deadlineMins) continue;
+                    double newCost = l.cost + graph.edgeDist[i] * costPerKm[m];
+                    if (newCost >= bestCost[v] || beaten(arriveTime, newCost, v)) continue;
+                    size_t slot = arriveTime - startMins;
+                    if (slot >= buckets.size()) buckets.resize(slot + 1);
+                    buckets[slot].push_back(arena.add(newCost, arriveTime, v, label, m));
+                    res.labels++;
+                }
+            }
+        }
+        bucket.clear();
+    }
+    return res;
+}
+
+// the answers of the three timed problems read off a frontier; cost -1 if there is none
+inline TimeResult paretoCheapest(const ParetoResult& p) {
+    return p.frontier.empty() ? TimeResult{{}, {}, -1, -1} : p.frontier.back();
+}
+
+inline TimeResult paretoFastest(const ParetoResult& p) {
+    return p.frontier.empty() ? TimeResult{{}, {}, -1, -1} : p.frontier.front();
+}
+
+inline TimeResult paretoByDeadline(const ParetoResult& p, int deadlineMins) {
+    TimeResult best = {{}, {}, -1, -1};
+    for (const TimeResult& r : p.frontier) {
+        if (r.arrivalTime <= deadlineMins) best = r;
+    }
+    return best;
+}
+
+#endif // PARETO_H
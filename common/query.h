@@ -0,0 +1,310 @@
+#ifndef QUERY_H
+#define QUERY_H
+
+#include "ch.h"
+#include "compress.h"
+#include "crp.h"
+#include "raptor.h"
+#include "pareto.h"
+
+// Text queries for the router tool: one line names a query type, the source and
+// destination as lon lat, and the start time / deadline where the type needs them.
+//
+//   car      srcLon srcLat dstLon dstLat                 shortest car distance (problem 1)
+//   metro    srcLon srcLat dstLon dstLat                 cheapest car + metro (problem 2)
+//   all      srcLon srcLat dstLon dstLat                 cheapest over all modes (problem 3)
+//   timed    srcLon srcLat dstLon dstLat START           cheapest with schedules (problem 4)
+//   fastest  srcLon srcLat dstLon dstLat START           fastest with schedules (problem 5)
+//   deadline srcLon srcLat dstLon dstLat START DEADLINE  cheapest arriving in time (problem 6)
+//   earliest srcLon srcLat dstLon dstLat START           earliest arrival with trips (timedep.h)
+//   transit  srcLon srcLat dstLon dstLat START           Pareto journeys on transit routes (raptor.h)
+//
+// Times are written like "5:30 PM" (or "17:30"). Parameters per type are the ones the
+// problem programs use.
+
+enum QueryType { Q_CAR, Q_METRO, Q_ALL, Q_TIMED, Q_FASTEST, Q_DEADLINE, Q_EARLIEST, Q_TRANSIT, NUM_QUERY_TYPES };
+
+struct QueryParams {
+    string name;
+    int timeArgs;
+    double costPerKm[NUM_MODES];
+    double speeds[NUM_MODES];
+    int intervals[NUM_MODES];
+    int schedStart[NUM_MODES];
+    int schedEnd[NUM_MODES];
+    bool allowed[NUM_MODES];
+    
+    int modeMask() const {
+        int mask = 0;
+        for (int m = 0; m < NUM_MODES; m++) {
+            if (allowed[m]) mask |= modeBit(m);
+        }
+        return mask;
+    }
+};
+
+inline const QueryParams& queryParams(int type) {
+    static const vector<QueryParams> table = [] {
+        int am6 = timeToMins("6:00 AM"), pm11 = timeToMins("11:00 PM");
+        vector<QueryParams> t(NUM_QUERY_TYPES);
+        t[Q_CAR] = {"car", 0, {20, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0},
+                    {true, false, false, false}};
+        t[Q_METRO] = {"metro", 0, {20, 5, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0},
+                      {true, true, false, false}};
+        t[Q_ALL] = {"all", 0, {20, 5, 7, 7}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0},
+                    {true, true, true, true}};
+        t[Q_TIMED] = {"timed", 1, {20, 5, 7, 7}, {30, 30, 30, 30}, {0, 15, 15, 15},
+                      {0, am6, am6, am6}, {0, pm11, pm11, pm11}, {true, true, true, true}};
+        t[Q_FASTEST] = {"fastest", 1, {20, 5, 7, 7}, {10, 10, 10, 10}, {0, 15, 15, 15},
+                        {0, am6, am6, am6}, {0, pm11, pm11, pm11}, {true, true, true, true}};
+        t[Q_DEADLINE] = {"deadline", 2, {20, 5, 7, 10}, {20, 15, 10, 12}, {0, 5, 20, 10},
+                         {0, timeToMins("1:00 AM"), timeToMins("7:00 AM"), am6},
+                         {0, pm11, timeToMins("10:00 PM"), pm11}, {true, true, true, true}};
+        t[Q_EARLIEST] = t[Q_FASTEST];
+        t[Q_EARLIEST].name = "earliest";
+        t[Q_TRANSIT] = t[Q_FASTEST];
+        t[Q_TRANSIT].name = "transit";
+        return t;
+    }();
+    return table[type];
+}
+
+// CRP customized for the price tables of the car, metro and all queries on one
+// partition; the metrics point into it, so it is built where it stays
+struct CRPTables {
+    CRPPartition part;
+    CRPMetric metrics[3]; // by query type: Q_CAR, Q_METRO, Q_ALL
+    
+    CRPTables() = default;
+    CRPTables(const CRPTables&) = delete;
+    CRPTables& operator=(const CRPTables&) = delete;
+    
+    void build(const Graph& graph) {
+        part.build(graph);
+        metrics[Q_CAR].customize(graph, part, CAR_PER_KM, CAR_ONLY);
+        for (int t : {Q_METRO, Q_ALL}) metrics[t].customize(graph, part, queryParams(t).costPerKm, queryParams(t).allowed);
+    }
+};
+
+struct Query {
+    int type = Q_CAR;
+    double srcLon = 0, srcLat = 0, dstLon = 0, dstLat = 0;
+    int startMins = 0, deadlineMins = 0;
+};
+
+struct QueryResult {
+    int start = -1, end = -1; // snapped nodes
+    bool found = false;
+    double cost = -1;         // km for car queries, Tk otherwise
+    int arrivalTime = -1;     // timed queries only
+    double exactArrival = -1; // earliest queries: arrival in fractional minutes
+    int boardings = 0;        // earliest / transit queries: transit vehicles boarded
+    vector<tuple<double,int,double>> options; // transit queries: arrival, boardings, cost of each Pareto journey
+    int frontier = 0;         // timed queries answered from the Pareto search: routes on its frontier
+    vector<int> path;
+    vector<int> modes;
+    vector<int> times;        // arrival minute per path node, timed queries only
+    int settled = 0;          // nodes settled by the search
+    long long pushes = 0;     // heap pushes of the search (labels for the timed ones)
+};
+
+// parse one query line; returns false with a message on malformed input
+inline bool parseQuery(const string& line, Query& q, string& error) {
+    stringstream ss(line);
+    string name;
+    ss >> name;
+    q = Query();
+    q.type = -1;
+    for (int t = 0; t < NUM_QUERY_TYPES; t++) {
+        if (queryParams(t).name == name) q.type = t;
+    }
+    if (q.type < 0) {
+        error = "unknown query type '" + name + "'";
+        return false;
+    }
+    if (!(ss >> q.srcLon >> q.srcLat >> q.dstLon >> q.dstLat)) {
+        error = "expected srcLon srcLat dstLon dstLat";
+        return false;
+    }
+    
+    // a time is "h:mm" optionally followed by an AM/PM token
+    vector<string> words;
+    string w;
+    while (ss >> w) words.push_back(w);
+    vector<int> times;
+    for (size_t i = 0; i < words.size(); i++) {
+        if (words[i].find(':') == string::npos) {
+            error = "bad time '" + words[i] + "'";
+            return false;
+        }
+        string t = words[i];
+        if (i + 1 < words.size() && words[i + 1].find(':') == string::npos) t += " " + words[++i];
+        times.push_back(timeToMins(t));
+    }
+    if ((int)times.size() != queryParams(q.type).timeArgs) {
+        error = name + " takes " + to_string(queryParams(q.type).timeArgs) + " time argument(s)";
+        return false;
+    }
+    if (times.size() > 0) q.startMins = times[0];
+    if (times.size() > 1) q.deadlineMins = times[1];
+    return true;
+}
+
+// the nodes a query snaps to, in r.start / r.end (-1 if there is none)
+inline void snapQuery(Graph& graph, const Query& q, QueryResult& r) {
+    STATS(StatTimer timer(PHASE_SNAP));
+    const QueryParams& p = queryParams(q.type);
+    double walkDist;
+    r.start = graph.getNearestNode(q.srcLat, q.srcLon, walkDist, p.modeMask());
+    r.end = graph.getNearestNode(q.dstLat, q.dstLon, walkDist, p.modeMask());
+}
+
+// answerQuery between the nodes already in r.start / r.end
+inline void searchQuery(const Graph& graph, const Query& q, QueryResult& r, SearchWorkspace& ws, int algo,
+                        const ContractionHierarchy* ch, const TransitNetwork* transit, bool pareto,
+                        const CompressedGraph* compressed, const CRPTables* crp) {
+    STATS(StatTimer timer(PHASE_SEARCH));
+    const QueryParams& p = queryParams(q.type);
+    long long pushesBefore = ws.pushCount();
+    if (q.type == Q_CAR || q.type == Q_METRO || q.type == Q_ALL) {
+        CostResult res;
+        const double* costPerKm = q.type == Q_CAR ? CAR_PER_KM : p.costPerKm;
+        const bool* allowed = q.type == Q_CAR ? CAR_ONLY : p.allowed;
+        if (q.type == Q_CAR && ch && !ch->empty()) res = ch->query(r.start, r.end, ws);
+        else if (crp) res = crp->metrics[q.type].query(r.start, r.end, ws);
+        else if (compressed) res = compressed->cheapestRoute(r.start, r.end, costPerKm, allowed, ws, algo);
+        else res = cheapestRoute(graph, r.start, r.end, costPerKm, allowed, ws, algo);
+        r.found = res.cost >= 0;
+        r.cost = res.cost;
+        r.path = res.path;
+        r.modes = res.modes;
+        r.settled = res.settled;
+        r.pushes = ws.pushCount() - pushesBefore;
+    } else if (q.type == Q_EARLIEST || q.type == Q_TRANSIT) {
+        TimeDepResult res;
+        if (q.type == Q_EARLIEST) {
+            res = earliestArrival(graph, r.start, r.end, q.startMins, p.costPerKm, p.speeds,
+                                  p.intervals, p.schedStart, p.schedEnd, p.allowed, ws);
+        } else if (transit && transit->stopCount() > 0) {
+            vector<TimeDepResult> set = transitJourneys(graph, *transit, r.start, r.end, q.startMins, p.costPerKm,
+                                                        p.speeds, p.intervals, p.schedStart, p.schedEnd, p.allowed, ws);
+            for (auto& j : set) r.options.push_back({j.arrivalTime, j.boardings, j.cost});
+            if (!set.empty()) res = set[0];
+        }
+        r.found = res.cost >= 0;
+        r.cost = res.cost;
+        r.exactArrival = res.arrivalTime;
+        r.arrivalTime = (int)floor(res.arrivalTime);
+        r.boardings = res.boardings;
+        r.settled = res.settled;
+        r.pushes = ws.pushCount() - pushesBefore;
+        r.path = res.path;
+        r.modes = res.modes;
+        for (double t : res.times) r.times.push_back((int)floor(t));
+    } else {
+        TimeResult res;
+        if (pareto) {
+            ParetoResult pr = paretoRoutes(graph, r.start, r.end, q.startMins, p.costPerKm, p.speeds, p.intervals,
+                                           p.schedStart, p.schedEnd, p.allowed,
+                                           q.type == Q_DEADLINE ? q.deadlineMins : INT_MAX);
+            if (q.type == Q_TIMED) res = paretoCheapest(pr);
+            else if (q.type == Q_FASTEST) res = paretoFastest(pr);
+            else res = paretoByDeadline(pr, q.deadlineMins);
+            r.frontier = pr.frontier.size();
+            r.settled = pr.labels;
+            r.pushes = pr.labels;
+        } else if (q.type == Q_TIMED) {
+            res = cheapestWithTime(graph, r.start, r.end, q.startMins, p.costPerKm, p.speeds,
+                                   p.intervals, p.schedStart, p.schedEnd, p.allowed);
+        } else if (q.type == Q_FASTEST) {
+            res = fastestRoute(graph, r.start, r.end, q.startMins, p.costPerKm, p.speeds,
+                               p.intervals, p.schedStart, p.schedEnd, p.allowed);
+        } else {
+            res = cheapestWithDeadline(graph, r.start, r.end, q.startMins, q.deadlineMins, p.costPerKm, p.speeds,
+                                       p.intervals, p.schedStart, p.schedEnd, p.allowed);
+        }
+        r.found = res.cost >= 0;
+        r.cost = res.cost;
+        r.arrivalTime = res.arrivalTime;
+        r.modes = res.modes;
+        if (!pareto) {
+            r.settled = res.settled;
+            r.pushes = res.pushes;
+        }
+        for (auto& [node, t] : res.pathWithTime) {
+            r.path.push_back(node);
+            r.times.push_back(t);
+        }
+    }
+}
+
+// snap both endpoints to nodes usable by the query's modes and run its search;
+// algo picks the strategy for the car / metro / all queries, and car queries use
+// the contraction hierarchy instead when one is given; the others (and car queries
+// without a hierarchy) use the CRP metrics of their price table when given, else the
+// compressed graph when one is given. Both are built from graph and must follow its
+// changes (see update.h). Transit queries search the
+// transit network given, which the caller builds once, and find no route without
+// one (a build costs a car search per stop pair). The timed, fastest and deadline
+// queries take their answer from the frontier of paretoRoutes; without pareto they
+// use the one-label-per-node searches, which are faster but can miss the cheapest
+// timed route.
+inline QueryResult answerQuery(Graph& graph, const Query& q, SearchWorkspace& ws, int algo = ALGO_DIJKSTRA,
+                               const ContractionHierarchy* ch = nullptr, const TransitNetwork* transit = nullptr,
+                               bool pareto = true, const CompressedGraph* compressed = nullptr,
+                               const CRPTables* crp = nullptr) {
+    QueryResult r;
+    snapQuery(graph, q, r);
+    if (r.start >= 0 && r.end >= 0) searchQuery(graph, q, r, ws, algo, ch, transit, pareto, compressed, crp);
+    return r;
+}
+
+inline QueryResult answerQuery(Graph& graph, const Query& q) {
+    SearchWorkspace ws;
+    return answerQuery(graph, q, ws);
+}
+
+// one-line summary in the style of the problem programs' console output
+inline string formatResult(const Query& q, const QueryResult& r) {
+    STATS(StatTimer timer(PHASE_OUTPUT));
+    stringstream ss;
+    ss << queryParams(q.type).name << ": ";
+    if (!r.found) {
+        ss << (q.type == Q_DEADLINE ? "No route found within deadline" : "No route found");
+        return ss.str();
+    }
+    ss << fixed;
+    if (q.type == Q_CAR) ss << "Distance = " << setprecision(4) << r.cost << " km";
+    else if (q.type == Q_FASTEST) ss << "Arrival Time: " << minsToTime(r.arrivalTime) << ", Cost = Tk " << setprecision(2) << r.cost;
+    else if (q.type == Q_EARLIEST) ss << "Arrival Time: " << minsToClock(r.exactArrival) << ", Cost = Tk " << setprecision(2) << r.cost
+                                      << ", " << r.boardings << " boardings";
+    else if (q.type == Q_TRANSIT) {
+        ss << "Arrival Time: " << minsToClock(r.exactArrival) << ", Cost = Tk " << setprecision(2) << r.cost << ", "
+           << r.boardings << " boardings, Pareto set:";
+        for (auto [arrival, boardings, cost] : r.options) {
+            ss << " [" << minsToClock(arrival) << " " << boardings << "x Tk " << cost << "]";
+        }
+    }
+    else if (q.type == Q_TIMED || q.type == Q_DEADLINE) ss << "Cost = Tk " << setprecision(2) << r.cost << ", Arrival: " << minsToTime(r.arrivalTime);
+    else ss << "Cost = Tk " << setprecision(2) << r.cost;
+    ss << ", " << r.path.size() << " nodes";
+    if (r.frontier > 0) ss << ", " << r.frontier << " on frontier";
+    if (r.settled > 0) ss << ", " << r.settled << (r.frontier > 0 ? " labels" : " settled");
+    return ss.str();
+}
+
+// full segment listing, as written to the problems' output files
+inline void printQueryRoute(ostream& out, const Graph& graph, const Query& q, const QueryResult& r) {
+    STATS(StatTimer timer(PHASE_OUTPUT));
+    const QueryParams& p = queryParams(q.type);
+    if (q.type <= Q_ALL) {
+        CostResult res = {r.path, r.modes, r.found ? r.cost * (q.type == Q_CAR ? p.costPerKm[0] : 1) : -1};
+        printRoute(out, graph, res, p.costPerKm);
+    } else {
+        TimeResult res = {{}, r.modes, r.found ? r.cost : -1, r.arrivalTime};
+        for (size_t i = 0; i < r.path.size(); i++) res.pathWithTime.push_back({r.path[i], r.times[i]});
+        printTimedRoute(out, graph, res, p.costPerKm, q.type == Q_DEADLINE ? "No route found within deadline!" : "No route found!");
+    }
+}
+
+#endif // QUERY_H
@@ -0,0 +1,571 @@
+#ifndef RAPTOR_H
+#define RAPTOR_H
+
+#include "timedep.h"
+
+// Round-based public transit router (RAPTOR) with car access, transfer and egress legs.
+//
+// The transit modes are turned into routes: a stop is a named stop or any node where a
+// line branches or ends, a hop is the polyline between two neighbouring stops of one
+// mode, and a route is a run of hops through stops with exactly two hops, stored once
+// per direction as contiguous arrays of stops and distances. Round k scans every route
+// through a stop improved in round k - 1, so a journey of round k boards k vehicles;
+// between rounds a car leg may join any two stops (distances precomputed), and the
+// start and destination reach the stops by car.
+//
+// Departures follow the same schedules as the node-level searches: boarding at a stop
+// waits for the mode's next departure there, then the vehicle rides on without
+// stopping. A stop keeps a bag of labels that are Pareto-optimal in (arrival, cost)
+// over the rounds so far, and the answer is every journey that is Pareto-optimal in
+// (arrival time, vehicles boarded, cost), so transfers = boardings - 1. A change
+// between two routes of the same mode at a junction is a new boarding here, where
+// earliestArrival can stay on board.
+
+class TransitNetwork {
+public:
+    // stops and the graph nodes they sit on
+    vector<int> stopNode;
+    vector<int> nodeStop; // -1 for nodes that are not stops
+    // routes: stops in riding order with the distance from the route's first stop
+    vector<int> routeMode;
+    vector<int> routeStart;
+    vector<int> routeStops;
+    vector<double> routeDist;
+    // polyline of the hop arriving at each route position (empty at position 0), with
+    // distances measured like routeDist
+    vector<int> geomStart;
+    vector<int> geomNodes;
+    vector<double> geomDist;
+    // routes through each stop as {route, position}
+    vector<int> stopRouteStart;
+    vector<pair<int,int>> stopRoutes;
+    // car distance (km) between every pair of stops, INF when not connected by road,
+    // and the route of each pair: its nodes after the first with the km to each
+    vector<double> carDist;
+    vector<int> carPathStart;
+    vector<int> carPathNodes;
+    vector<double> carPathDist;
+    
+    int stopCount() const { return (int)stopNode.size(); }
+    int routeCount() const { return (int)routeMode.size(); }
+    int routeLength(int r) const { return routeStart[r + 1] - routeStart[r]; }
+    double car(int a, int b) const { return carDist[(size_t)a * stopCount() + b]; }
+    int carPath(int a, int b) const { return a * stopCount() + b; }
+    
+    void build(const Graph& graph) {
+        stopNode.clear();
+        nodeStop.assign(graph.nodeCount, -1);
+        routeMode.clear();
+        routeStart.assign(1, 0);
+        routeStops.clear();
+        routeDist.clear();
+        geomStart.assign(1, 0);
+        geomNodes.clear();
+        geomDist.clear();
+        
+        for (int m = 1; m < NUM_MODES; m++) buildRoutes(graph, m);
+        
+        stopRouteStart.assign(stopCount() + 1, 0);
+        for (int i = 0; i < (int)routeStops.size(); i++) stopRouteStart[routeStops[i] + 1]++;
+        for (int s = 0; s < stopCount(); s++) stopRouteStart[s + 1] += stopRouteStart[s];
+        stopRoutes.resize(routeStops.size());
+        vector<int> fill(stopRouteStart.begin(), stopRouteStart.end() - 1);
+        for (int r = 0; r < routeCount(); r++) {
+            for (int i = 0; i < routeLength(r); i++) stopRoutes[fill[routeStops[routeStart[r] + i]]++] = {r, i};
+        }
+        
+        carDist.assign((size_t)stopCount() * stopCount(), INF);
+        buildCarTable(graph, {});
+    }
+    
+    // after live changes to the u-v edges of these {u, v, mode} steps: a transit edge
+    // changes the routes, so everything is rebuilt; car edges only change the car table,
+    // and when none got shorter only its rows (from one stop) with a route over one of
+    // them. Returns the number of rows recomputed.
+    int edgesChanged(const Graph& graph, const vector<array<int,3>>& steps, bool onlyLonger) {
+        for (auto& s : steps) {
+            if (s[2] != 0) {
+                build(graph);
+                return stopCount();
+            }
+        }
+        int n = stopCount();
+        vector<char> redo(n, !onlyLonger);
+        if (onlyLonger) {
+            vector<char> touched(graph.nodeCount, 0);
+            set<pair<int,int>> changed;
+            for (auto& s : steps) {
+                touched[s[0]] = touched[s[1]] = 1;
+                changed.insert({s[0], s[1]});
+                changed.insert({s[1], s[0]});
+            }
+            for (int a = 0; a < n; a++) {
+                for (int b = 0; b < n && !redo[a]; b++) {
+                    int prev = stopNode[a];
+                    for (int k = carPathStart[carPath(a, b)]; k < carPathStart[carPath(a, b) + 1]; k++) {
+                        int cur = carPathNodes[k];
+                        if (touched[prev] && touched[cur] && changed.count({prev, cur})) {
+                            redo[a] = 1;
+                            break;
+                        }
+                        prev = cur;
+                    }
+                }
+            }
+        }
+        int rows = count(redo.begin(), redo.end(), 1);
+        if (rows > 0) buildCarTable(graph, redo);
+        return rows;
+    }
+    
+    // road distance (km) from a graph node to every stop, INF where the search did not
+    // get. It stops once every stop is settled, once target is (so ws.get(target) is
+    // final), or past radius; ws keeps the tree, so routes can be read back from it.
+    void carDistances(const Graph& graph, int from, SearchWorkspace& ws, vector<double>& out, int target = -1,
+                      double radius = INF) const {
+        ws.reset(graph.nodeCount);
+        ws.set(from, 0, -1, 0);
+        ws.push(0, from);
+        int left = stopCount();
+        while (!ws.empty() && left > 0) {
+            auto [d, u] = ws.pop();
+            if (d > ws.dist[u]) {
+                STATS(statCount(STAT_STALE));
+                continue;
+            }
+            if (d > radius || u == target) break;
+            if (nodeStop[u] >= 0) left--;
+            STATS(statCount(STAT_SETTLED));
+            STATS(statCount(STAT_RELAXED, graph.edgeEnd(u, 0) - graph.edgeBegin(u, 0)));
+            for (int i = graph.edgeBegin(u, 0); i < graph.edgeEnd(u, 0); i++) {
+                int v = graph.edgeTo[i];
+                double nd = d + graph.edgeDist[i];
+                if (nd < ws.get(v)) {
+                    ws.set(v, nd, u, 0);
+                    ws.push(nd, v);
+                }
+            }
+        }
+        out.resize(stopCount());
+        for (int s = 0; s < stopCount(); s++) out[s] = ws.get(stopNode[s]);
+    }
+
+private:
+    // car distances and routes from the stops marked in redo (all of them when it is
+    // empty); the routes of the other rows are copied over
+    void buildCarTable(const Graph& graph, const vector<char>& redo) {
+        int n = stopCount();
+        vector<int> oldStart, oldNodes;
+        vector<double> oldDist;
+        oldStart.swap(carPathStart);
+        oldNodes.swap(carPathNodes);
+        oldDist.swap(carPathDist);
+        carPathStart.assign(1, 0);
+        
+        SearchWorkspace ws;
+        vector<double> row;
+        vector<int> path, modes;
+        for (int a = 0; a < n; a++) {
+            if (!redo.empty() && !redo[a]) {
+                int from = oldStart[carPath(a, 0)], to = oldStart[carPath(a, n - 1) + 1];
+                int shift = (int)carPathNodes.size() - from;
+                carPathNodes.insert(carPathNodes.end(), oldNodes.begin() + from, oldNodes.begin() + to);
+                carPathDist.insert(carPathDist.end(), oldDist.begin() + from, oldDist.begin() + to);
+                for (int b = 0; b < n; b++) carPathStart.push_back(oldStart[carPath(a, b) + 1] + shift);
+                continue;
+            }
+            carDistances(graph, stopNode[a], ws, row);
+            copy(row.begin(), row.end(), carDist.begin() + (size_t)a * n);
+            for (int b = 0; b < n; b++) {
+                if (row[b] < INF) ws.tracePath(stopNode[b], path, modes);
+                else path.clear();
+                for (size_t k = 1; k < path.size(); k++) {
+                    carPathNodes.push_back(path[k]);
+                    carPathDist.push_back(ws.dist[path[k]]);
+                }
+                carPathStart.push_back(carPathNodes.size());
+            }
+        }
+    }
+    
+    struct Hop {
+        int to;        // stop at the far end
+        int first;     // graph node right after the near stop
+        vector<int> nodes;
+        vector<double> dist;
+    };
+    
+    int addStop(int node) {
+        if (nodeStop[node] < 0) {
+            nodeStop[node] = stopNode.size();
+            stopNode.push_back(node);
+        }
+        return nodeStop[node];
+    }
+    
+    // the shortest edge of the mode from u to each of its neighbours, self loops left out
+    static void neighbours(const Graph& graph, int u, int mode, vector<pair<int,double>>& out) {
+        out.clear();
+        for (int i = graph.edgeBegin(u, mode); i < graph.edgeEnd(u, mode); i++) {
+            int v = graph.edgeTo[i];
+            if (v == u) continue;
+            bool seen = false;
+            for (auto& [w, d] : out) {
+                if (w == v) {
+                    d = min(d, (double)graph.edgeDist[i]);
+                    seen = true;
+                }
+            }
+            if (!seen) out.push_back({v, graph.edgeDist[i]});
+        }
+    }
+    
+    void buildRoutes(const Graph& graph, int mode) {
+        vector<pair<int,double>> nb;
+        vector<int> stops;
+        vector<char> isRouteStop(graph.nodeCount, 0);
+        for (int u = 0; u < graph.nodeCount; u++) {
+            if (graph.edgeBegin(u, mode) == graph.edgeEnd(u, mode)) continue;
+            neighbours(graph, u, mode, nb);
+            if (graph.nodes[u].isStop || nb.size() != 2) {
+                isRouteStop[u] = 1;
+                stops.push_back(u);
+            }
+        }
+        
+        // hops out of every stop, walking the polyline to the next stop
+        map<int, vector<Hop>> hops;
+        for (int u : stops) {
+            vector<pair<int,double>> out;
+            neighbours(graph, u, mode, out);
+            for (auto [v, d] : out) {
+                Hop h;
+                h.first = v;
+                int prev = u, cur = v;
+                double along = d;
+                while (true) {
+                    h.nodes.push_back(cur);
+                    h.dist.push_back(along);
+                    if (isRouteStop[cur]) break;
+                    neighbours(graph, cur, mode, nb);
+                    auto next = nb[0].first != prev ? nb[0] : nb[1];
+                    prev = cur;
+                    cur = next.first;
+                    along += next.second;
+                }
+                h.to = cur;
+                hops[u].push_back(h);
+            }
+        }
+        
+        // chain hops through stops that have exactly two, starting at the others
+        auto through = [&](int u) {
+            const vector<Hop>& hs = hops[u];
+            return hs.size() == 2 && hs[0].first != hs[1].first;
+        };
+        set<pair<int,int>> used; // {stop, first node} of hops already on a route
+        auto walk = [&](int u, const Hop* h) {
+            vector<int> seq = {u};
+            vector<const Hop*> legs;
+            while (!used.count({u, h->first})) {
+                used.insert({u, h->first});
+                int prevNode = h->nodes.size() > 1 ? h->nodes[h->nodes.size() - 2] : u;
+                used.insert({h->to, prevNode});
+                seq.push_back(h->to);
+                legs.push_back(h);
+                u = h->to;
+                if (!through(u)) break;
+                const vector<Hop>& hs = hops[u];
+                h = hs[0].first != prevNode ? &hs[0] : &hs[1];
+            }
+            if (!legs.empty()) addRoute(mode, seq, legs);
+        };
+        for (int u : stops) {
+            if (through(u)) continue;
+            for (const Hop& h : hops[u]) walk(u, &h);
+        }
+        for (int u : stops) { // loops of through stops
+            for (const Hop& h : hops[u]) walk(u, &h);
+        }
+    }
+    
+    // the route along seq and the same stops the other way round
+    void addRoute(int mode, const vector<int>& seq, const vector<const Hop*>& legs) {
+        for (int dir = 0; dir < 2; dir++) {
+            routeMode.push_back(mode);
+            double base = 0;
+            int n = seq.size();
+            for (int k = 0; k < n; k++) {
+                int i = dir == 0 ? k : n - 1 - k;
+                if (k > 0) {
+                    const Hop& h = *legs[dir == 0 ? i - 1 : i];
+                    int len = h.nodes.size();
+                    double hopLen = h.dist.back();
+                    for (int j = 0; j < len; j++) {
+                        if (dir == 0) {
+                            geomNodes.push_back(h.nodes[j]);
+                            geomDist.push_back(base + h.dist[j]);
+                        } else {
+                            // walk the hop backwards: its nodes before the last, then its start
+                            int node = j + 1 < len ? h.nodes[len - 2 - j] : seq[i];
+                            double d = j + 1 < len ? h.dist[len - 2 - j] : 0;
+                            geomNodes.push_back(node);
+                            geomDist.push_back(base + hopLen - d);
+                        }
+                    }
+                    base += hopLen;
+                }
+                routeStops.push_back(addStop(seq[i]));
+                routeDist.push_back(base);
+                geomStart.push_back(geomNodes.size());
+            }
+            routeStart.push_back(routeStops.size());
+        }
+    }
+};
+
+// Pareto-optimal journeys from start to end leaving at startMins, ordered by arrival;
+// each journey's settled is the number of labels the search created
+inline vector<TimeDepResult> transitJourneys(const Graph& graph, const TransitNetwork& net, int start, int end,
+                                             double startMins, const double costPerKm[], const double speeds[],
+                                             const int intervals[], const int schedStart[], const int schedEnd[],
+                                             const bool allowed[], SearchWorkspace& ws, int maxRounds = 5) {
+    struct Label {
+        double arrival, cost;
+        int round;      // vehicles boarded
+        int stop;
+        int parent;     // label at the boarding stop or the car leg's start, -1 from the start node
+        int route;      // route ridden to this stop, -1 for a car leg
+        int boardPos, alightPos;
+        double depart;  // departure from the boarding stop
+        bool dead;      // dominated by a later label of the same round
+    };
+    struct Journey {
+        double arrival, cost;
+        int round;
+        int label;      // last label before the car leg to end, -1 for a car-only journey
+    };
+    vector<Label> labels;
+    vector<Journey> journeys;
+    int stops = net.stopCount();
+    bool car = allowed[0];
+    auto carMins = [&](double km) { return km / speeds[0] * 60; };
+    
+    // car legs from start and to end; a stop farther by car than driving straight
+    // there is no use, so both searches stop at that distance
+    vector<double> fromStart(stops, INF), toEnd(stops, INF);
+    SearchWorkspace& bw = ws.other();
+    double direct = INF;
+    if (car) {
+        net.carDistances(graph, start, ws, fromStart, end);
+        direct = ws.get(end);
+        net.carDistances(graph, end, bw, toEnd, -1, direct);
+    } else {
+        if (net.nodeStop[start] >= 0) fromStart[net.nodeStop[start]] = 0;
+        if (net.nodeStop[end] >= 0) toEnd[net.nodeStop[end]] = 0;
+    }
+    
+    auto dominated = [&](double arrival, double cost, int round) {
+        for (const Journey& j : journeys) {
+            if (j.round <= round && j.arrival <= arrival && j.cost <= cost) return true;
+        }
+        return false;
+    };
+    auto addJourney = [&](double arrival, double cost, int round, int label) {
+        if (dominated(arrival, cost, round)) return;
+        vector<Journey> kept;
+        for (const Journey& j : journeys) {
+            if (!(round <= j.round && arrival <= j.arrival && cost <= j.cost)) kept.push_back(j);
+        }
+        kept.push_back({arrival, cost, round, label});
+        journeys.swap(kept);
+    };
+    if (start == end) addJourney(startMins, 0, 0, -1);
+    else if (car && direct < INF) addJourney(startMins + carMins(direct), direct * costPerKm[0], 0, -1);
+    
+    // bag of each stop over all rounds so far; labels of the round before are boarded
+    vector<vector<int>> bag(stops), prevRound(stops), thisRound(stops);
+    auto addLabel = [&](Label l) {
+        if (dominated(l.arrival, l.cost, l.round)) return;
+        for (int i : bag[l.stop]) {
+            if (!labels[i].dead && labels[i].arrival <= l.arrival && labels[i].cost <= l.cost) return;
+        }
+        int id = labels.size();
+        for (int i : bag[l.stop]) {
+            if (labels[i].round == l.round && l.arrival <= labels[i].arrival && l.cost <= labels[i].cost) {
+                labels[i].dead = true;
+            }
+        }
+        labels.push_back(l);
+        bag[l.stop].push_back(id);
+        thisRound[l.stop].push_back(id);
+        if (l.round > 0 && toEnd[l.stop] < INF) { // without a ride it is the direct drive
+            addJourney(l.arrival + carMins(toEnd[l.stop]), l.cost + toEnd[l.stop] * costPerKm[0], l.round, id);
+        }
+    };
+    
+    for (int s = 0; s < stops; s++) {
+        if (fromStart[s] < INF) {
+            addLabel({startMins + carMins(fromStart[s]), fromStart[s] * costPerKm[0], 0, s, -1, -1, 0, 0, 0, false});
+        }
+    }
+    
+    struct Riding {
+        double key;      // departure the vehicle would have had at the route's first stop
+        double baseCost; // cost at boarding less the route's price up to the boarding stop
+        int label, boardPos;
+    };
+    vector<int> firstPos(net.routeCount(), -1);
+    vector<Riding> riding;
+    for (int round = 1; round <= maxRounds; round++) {
+        swap(prevRound, thisRound);
+        for (auto& l : thisRound) l.clear();
+        
+        // earliest improved position on each route
+        vector<int> queue;
+        for (int s = 0; s < stops; s++) {
+            if (prevRound[s].empty()) continue;
+            for (int k = net.stopRouteStart[s]; k < net.stopRouteStart[s + 1]; k++) {
+                auto [r, pos] = net.stopRoutes[k];
+                if (!allowed[net.routeMode[r]] || pos == net.routeLength(r) - 1) continue;
+                if (firstPos[r] < 0) queue.push_back(r);
+                if (firstPos[r] < 0 || pos < firstPos[r]) firstPos[r] = pos;
+            }
+        }
+        if (queue.empty()) break;
+        
+        for (int r : queue) {
+            int m = net.routeMode[r];
+            double rate = costPerKm[m];
+            bool scheduled = intervals[m] > 0;
+            auto offset = [&](int pos) { return net.routeDist[net.routeStart[r] + pos] / speeds[m] * 60; };
+            riding.clear();
+            for (int pos = firstPos[r]; pos < net.routeLength(r); pos++) {
+                int s = net.routeStops[net.routeStart[r] + pos];
+                double along = net.routeDist[net.routeStart[r] + pos];
+                for (const Riding& v : riding) {
+                    double depart = v.key + offset(v.boardPos);
+                    addLabel({v.key + offset(pos), v.baseCost + along * rate, round, s, v.label, r, v.boardPos, pos, depart,
+                              false});
+                }
+                for (int i : prevRound[s]) {
+                    const Label& l = labels[i];
+                    if (l.dead) continue;
+                    double depart = l.arrival;
+                    if (scheduled) {
+                        int dep = departureAfter(l.arrival, intervals[m], schedStart[m], schedEnd[m]);
+                        if (dep == -1) continue;
+                        depart = dep;
+                    }
+                    Riding v = {depart - offset(pos), l.cost - along * rate, i, pos};
+                    bool beaten = false;
+                    for (const Riding& w : riding) beaten = beaten || (w.key <= v.key && w.baseCost <= v.baseCost);
+                    if (beaten) continue;
+                    vector<Riding> kept = {v};
+                    for (const Riding& w : riding) {
+                        if (!(v.key <= w.key && v.baseCost <= w.baseCost)) kept.push_back(w);
+                    }
+                    riding.swap(kept);
+                }
+            }
+            firstPos[r] = -1;
+        }
+        
+        // car legs between stops from the labels the vehicles just reached
+        if (car) {
+            vector<int> reached;
+            for (int s = 0; s < stops; s++) {
+                for (int i : thisRound[s]) reached.push_back(i);
+            }
+            for (int i : reached) {
+                if (labels[i].dead) continue;
+                Label l = labels[i];
+                for (int s = 0; s < stops; s++) {
+                    double km = net.car(l.stop, s);
+                    if (s == l.stop || km >= INF) continue;
+                    addLabel({l.arrival + carMins(km), l.cost + km * costPerKm[0], round, s, i, -1, 0, 0, 0, false});
+                }
+            }
+        }
+    }
+    
+    // expand each journey to graph nodes, last leg first
+    sort(journeys.begin(), journeys.end(), [](const Journey& a, const Journey& b) {
+        return tie(a.arrival, a.round, a.cost) < tie(b.arrival, b.round, b.cost);
+    });
+    vector<TimeDepResult> results;
+    for (const Journey& j : journeys) {
+        TimeDepResult res;
+        res.cost = j.cost;
+        res.arrivalTime = j.arrival;
+        res.boardings = j.round;
+        res.settled = labels.size();
+        
+        // pieces of the route, each from the end of the one before; the car legs from
+        // start and to end are read from the trees of the two searches above
+        struct Piece { vector<int> path, modes; vector<double> times; };
+        vector<Piece> pieces;
+        auto carStep = [&](Piece& p, int node, double at) {
+            p.path.push_back(node);
+            p.modes.push_back(0);
+            p.times.push_back(at);
+        };
+        auto fromStartPiece = [&](int to) {
+            Piece p;
+            for (int v = to; v != start; v = ws.parent[v]) carStep(p, v, startMins + carMins(ws.dist[v]));
+            reverse(p.path.begin(), p.path.end());
+            reverse(p.times.begin(), p.times.end());
+            pieces.push_back(p);
+        };
+        
+        int last = j.label;
+        if (last < 0) {
+            fromStartPiece(end);
+        } else {
+            Piece egress;
+            int from = net.stopNode[labels[last].stop];
+            for (int v = from; v != end; v = bw.parent[v]) {
+                carStep(egress, bw.parent[v], labels[last].arrival + carMins(bw.dist[from] - bw.dist[bw.parent[v]]));
+            }
+            pieces.push_back(egress);
+            for (int i = last; i != -1; i = labels[i].parent) {
+                const Label& l = labels[i];
+                if (l.parent < 0) {
+                    fromStartPiece(net.stopNode[l.stop]);
+                    continue;
+                }
+                Piece p;
+                if (l.route < 0) {
+                    int a = labels[l.parent].stop, k = net.carPath(a, l.stop);
+                    for (int g = net.carPathStart[k]; g < net.carPathStart[k + 1]; g++) {
+                        carStep(p, net.carPathNodes[g], labels[l.parent].arrival + carMins(net.carPathDist[g]));
+                    }
+                    pieces.push_back(p);
+                    continue;
+                }
+                int r = l.route, m = net.routeMode[r];
+                double boardDist = net.routeDist[net.routeStart[r] + l.boardPos];
+                int from0 = net.geomStart[net.routeStart[r] + l.boardPos + 1];
+                int to0 = net.geomStart[net.routeStart[r] + l.alightPos + 1];
+                for (int g = from0; g < to0; g++) {
+                    p.path.push_back(net.geomNodes[g]);
+                    p.modes.push_back(m);
+                    p.times.push_back(l.depart + (net.geomDist[g] - boardDist) / speeds[m] * 60);
+                }
+                pieces.push_back(p);
+            }
+        }
+        
+        res.path.push_back(start);
+        res.times.push_back(startMins);
+        for (int k = (int)pieces.size() - 1; k >= 0; k--) {
+            res.path.insert(res.path.end(), pieces[k].path.begin(), pieces[k].path.end());
+            res.modes.insert(res.modes.end(), pieces[k].modes.begin(), pieces[k].modes.end());
+            res.times.insert(res.times.end(), pieces[k].times.begin(), pieces[k].times.end());
+        }
+        results.push_back(res);
+    }
+    return results;
+}
+
+#endif // RAPTOR_H
@@ -0,0 +1,705 @@
+#ifndef ROUTING_H
+#define ROUTING_H
+
+#include "graph.h"
+#include "heap.h"
+#include "output.h"
+#include <memory>
+
+// Search routines shared by the problem programs and the router tool.
+// All of them expect a frozen graph (see Graph::freeze).
+
+struct CostResult {
+    vector<int> path;
+    vector<int> modes;
+    double cost;
+    int settled = 0; // nodes taken off the heap (both directions for bidirectional search)
+};
+
+// search strategy for distance / cost queries; all return optimal routes
+enum SearchAlgo { ALGO_DIJKSTRA, ALGO_ASTAR, ALGO_BIDIR_ASTAR };
+
+inline const char* algoName(int algo) {
+    if (algo == ALGO_ASTAR) return "astar";
+    if (algo == ALGO_BIDIR_ASTAR) return "bidir";
+    return "dijkstra";
+}
+
+struct TimeResult {
+    vector<pair<int,int>> pathWithTime; // {node, arrival time}
+    vector<int> modes;
+    double cost;
+    int arrivalTime;
+    int settled = 0; // labels expanded by the search
+    int pushes = 0;  // labels pushed on the heap
+};
+
+// Reusable per-thread search state. dist/parent are only valid where stamp equals
+// the current generation, so starting a new search is O(1) instead of refilling n
+// entries, and the queue keeps its capacity between queries. queue picks the priority
+// queue behind push / pop (see heap.h); searches still skip entries whose key is worse
+// than the node's dist, which only the binary heap leaves behind.
+struct SearchWorkspace {
+    vector<double> dist;
+    vector<double> pot; // A* potential of each reached node
+    vector<int> parent;
+    vector<unsigned char> parentMode;
+    vector<unsigned> stamp;
+    unsigned generation = 0;
+    int queue = QUEUE_BINARY;
+    vector<pair<double,int>> heap; // QUEUE_BINARY: min-heap, same order as priority_queue with greater<>
+    QuadHeap quad;
+    RadixHeap radix;
+    unique_ptr<SearchWorkspace> backward; // second side of bidirectional searches
+    long long pushes = 0; // entries pushed over the workspace's lifetime
+    
+    // the backward workspace, created on first use with the same queue
+    SearchWorkspace& other() {
+        if (!backward) backward.reset(new SearchWorkspace());
+        backward->queue = queue;
+        return *backward;
+    }
+    
+    void reset(int n) {
+        if ((int)stamp.size() != n) {
+            dist.resize(n);
+            pot.resize(n);
+            parent.resize(n);
+            parentMode.resize(n);
+            stamp.assign(n, 0);
+            generation = 0;
+        }
+        if (++generation == 0) { // wrapped: clear once every 2^32 searches
+            fill(stamp.begin(), stamp.end(), 0);
+            generation = 1;
+        }
+        heap.clear();
+        if (queue == QUEUE_QUAD) quad.clear(n);
+        if (queue == QUEUE_RADIX) radix.clear();
+    }
+    
+    double get(int v) const { return stamp[v] == generation ? dist[v] : INF; }
+    
+    void set(int v, double d, int p, int mode) {
+        stamp[v] = generation;
+        dist[v] = d;
+        parent[v] = p;
+        parentMode[v] = (unsigned char)mode;
+    }
+    
+    bool empty() const {
+        if (queue == QUEUE_QUAD) return quad.empty();
+        if (queue == QUEUE_RADIX) return radix.empty();
+        return heap.empty();
+    }
+    
+    // smallest key in the queue, which must not be empty
+    double topKey() {
+        if (queue == QUEUE_QUAD) return quad.top().first;
+        if (queue == QUEUE_RADIX) return radix.top().first;
+        return heap.front().first;
+    }
+    
+    size_t size() const {
+        if (queue == QUEUE_QUAD) return quad.items.size();
+        if (queue == QUEUE_RADIX) return radix.count;
+        return heap.size();
+    }
+    
+    void push(double d, int v) {
+        pushes++;
+        if (queue == QUEUE_QUAD) quad.push(d, v);
+        else if (queue == QUEUE_RADIX) radix.push(d, v);
+        else {
+            heap.push_back({d, v});
+            push_heap(heap.begin(), heap.end(), greater<pair<double,int>>());
+        }
+        STATS(statMax(STAT_MAX_QUEUE, size()));
+    }
+    
+    pair<double,int> pop() {
+        if (queue == QUEUE_QUAD) return quad.pop();
+        if (queue == QUEUE_RADIX) return radix.pop();
+        pop_heap(heap.begin(), heap.end(), greater<pair<double,int>>());
+        pair<double,int> top = heap.back();
+        heap.pop_back();
+        return top;
+    }
+    
+    // pushes of both sides so far; a search's count is the difference across it
+    long long pushCount() const { return pushes + (backward ? backward->pushes : 0); }
+    
+    // nodes and modes from the search root to end
+    void tracePath(int end, vector<int>& path, vector<int>& modes) const {
+        STATS(StatTimer timer(PHASE_UNPACK));
+        path.clear();
+        modes.clear();
+        for (int v = end; v != -1; v = parent[v]) {
+            path.push_back(v);
+            if (parent[v] != -1) modes.push_back(parentMode[v]);
+        }
+        reverse(path.begin(), path.end());
+        reverse(modes.begin(), modes.end());
+    }
+};
+
+// cheapest per-km rate among the allowed modes: rate * straight-line distance is a
+// lower bound on the cost of any route, since every edge is as long as its chord
+inline double minRate(const double costPerKm[], const bool allowed[]) {
+    double rate = INF;
+    for (int m = 0; m < NUM_MODES; m++) {
+        if (allowed[m]) rate = min(rate, costPerKm[m]);
+    }
+    return rate >= INF ? 0 : max(0.0, rate);
+}
+
+// slightly shrunk so rounding in haversine can never make the bound inconsistent
+const double ASTAR_SLACK = 1 - 1e-9;
+
+// Dijkstra's algorithm for cheapest route (A* when algo is ALGO_ASTAR)
+inline CostResult unidirectionalSearch(const Graph& graph, int start, int end, const double costPerKm[],
+                                       const bool allowed[], SearchWorkspace& ws, int algo) {
+    STATS(StatTimer timer(PHASE_SEARCH));
+    double rate = algo == ALGO_ASTAR ? minRate(costPerKm, allowed) * ASTAR_SLACK : 0;
+    const Node& target = graph.nodes[end];
+    auto bound = [&](int v) {
+        if (rate == 0) return 0.0;
+        return rate * haversine(graph.nodes[v].lat, graph.nodes[v].lon, target.lat, target.lon);
+    };
+    
+    CostResult res;
+    res.settled = 0;
+    ws.reset(graph.nodeCount);
+    ws.set(start, 0, -1, 0);
+    ws.pot[start] = bound(start);
+    ws.push(ws.pot[start], start);
+    
+    while (!ws.empty()) {
+        auto [k, u] = ws.pop();
+        
+        double c = ws.dist[u];
+        if (k > c + ws.pot[u]) {
+            STATS(statCount(STAT_STALE));
+            continue;
+        }
+        res.settled++;
+        STATS(statCount(STAT_SETTLED));
+        if (u == end) break;
+        
+        for (int m = 0; m < NUM_MODES; m++) {
+            if (!allowed[m]) continue;
+            STATS(statCount(STAT_RELAXED, graph.edgeEnd(u, m) - graph.edgeBegin(u, m)));
+            for (int i = graph.edgeBegin(u, m); i < graph.edgeEnd(u, m); i++) {
+                int v = graph.edgeTo[i];
+                double edgeCost = graph.edgeDist[i] * costPerKm[m];
+                double newCost = c + edgeCost;
+                double old = ws.get(v);
+                if (newCost < old) {
+                    double pv = old < INF ? ws.pot[v] : bound(v);
+                    ws.set(v, newCost, u, m);
+                    ws.pot[v] = pv;
+                    ws.push(newCost + pv, v);
+                }
+            }
+        }
+    }
+    
+    if (ws.get(end) >= INF) {
+        res.cost = -1;
+        return res;
+    }
+    
+    ws.tracePath(end, res.path, res.modes);
+    res.cost = ws.dist[end];
+    return res;
+}
+
+// Bidirectional A* with the average potential p(v) = (h_end(v) - h_start(v)) / 2:
+// the forward search uses p, the backward search -p, so both see the same
+// non-negative reduced costs and can stop once the two heap tops together reach
+// the best meeting cost. Edges are undirected, so the backward search walks the
+// same adjacency.
+inline CostResult bidirectionalSearch(const Graph& graph, int start, int end, const double costPerKm[],
+                                      const bool allowed[], SearchWorkspace& ws) {
+    STATS(StatTimer timer(PHASE_SEARCH));
+    SearchWorkspace& fw = ws;
+    SearchWorkspace& bw = ws.other();
+    double rate = minRate(costPerKm, allowed) * ASTAR_SLACK;
+    const Node& source = graph.nodes[start];
+    const Node& target = graph.nodes[end];
+    auto potential = [&](int v) {
+        if (rate == 0) return 0.0;
+        const Node& x = graph.nodes[v];
+        return rate * (haversine(x.lat, x.lon, target.lat, target.lon) - haversine(source.lat, source.lon, x.lat, x.lon)) / 2;
+    };
+    
+    CostResult res;
+    res.settled = 0;
+    fw.reset(graph.nodeCount);
+    bw.reset(graph.nodeCount);
+    fw.set(start, 0, -1, 0);
+    fw.pot[start] = potential(start);
+    fw.push(fw.pot[start], start);
+    bw.set(end, 0, -1, 0);
+    bw.pot[end] = -potential(end);
+    bw.push(bw.pot[end], end);
+    
+    double best = start == end ? 0 : INF;
+    int meet = start == end ? start : -1;
+    
+    while (!fw.empty() && !bw.empty()) {
+        if (fw.topKey() + bw.topKey() >= best) break;
+        
+        bool forward = fw.topKey() <= bw.topKey();
+        SearchWorkspace& a = forward ? fw : bw;
+        SearchWorkspace& b = forward ? bw : fw;
+        auto [k, u] = a.pop();
+        
+        double c = a.dist[u];
+        if (k > c + a.pot[u]) {
+            STATS(statCount(STAT_STALE));
+            continue;
+        }
+        res.settled++;
+        STATS(statCount(STAT_SETTLED));
+        
+        for (int m = 0; m < NUM_MODES; m++) {
+            if (!allowed[m]) continue;
+            STATS(statCount(STAT_RELAXED, graph.edgeEnd(u, m) - graph.edgeBegin(u, m)));
+            for (int i = graph.edgeBegin(u, m); i < graph.edgeEnd(u, m); i++) {
+                int v = graph.edgeTo[i];
+                double newCost = c + graph.edgeDist[i] * costPerKm[m];
+                double old = a.get(v);
+                if (newCost < old) {
+                    double pv = old < INF ? a.pot[v] : (forward ? potential(v) : -potential(v));
+                    a.set(v, newCost, u, m);
+                    a.pot[v] = pv;
+                    a.push(newCost + pv, v);
+                    
+                    double other = b.get(v);
+                    if (other < INF && newCost + other < best) {
+                        best = newCost + other;
+                        meet = v;
+                    }
+                }
+            }
+        }
+    }
+    
+    if (meet < 0) {
+        res.cost = -1;
+        return res;
+    }
+    
+    STATS(StatTimer unpackTimer(PHASE_UNPACK));
+    fw.tracePath(meet, res.path, res.modes);
+    for (int v = meet; bw.parent[v] != -1; v = bw.parent[v]) {
+        res.path.push_back(bw.parent[v]);
+        res.modes.push_back(bw.parentMode[v]);
+    }
+    res.cost = best;
+    return res;
+}
+
+// cheapest route with the chosen strategy
+inline CostResult cheapestRoute(const Graph& graph, int start, int end, const double costPerKm[], const bool allowed[],
+                                SearchWorkspace& ws, int algo = ALGO_DIJKSTRA) {
+    if (algo == ALGO_BIDIR_ASTAR) return bidirectionalSearch(graph, start, end, costPerKm, allowed, ws);
+    return unidirectionalSearch(graph, start, end, costPerKm, allowed, ws, algo);
+}
+
+inline CostResult cheapestRoute(const Graph& graph, int start, int end, const double costPerKm[], const bool allowed[]) {
+    SearchWorkspace ws;
+    return cheapestRoute(graph, start, end, costPerKm, allowed, ws);
+}
+
+// shortest car route: the cost search with car only at 1 per km
+const double CAR_PER_KM[NUM_MODES] = {1, 0, 0, 0};
+const bool CAR_ONLY[NUM_MODES] = {true, false, false, false};
+
+inline pair<vector<int>, double> shortestCarRoute(const Graph& graph, int start, int end, SearchWorkspace& ws,
+                                                  int algo = ALGO_DIJKSTRA) {
+    CostResult res = cheapestRoute(graph, start, end, CAR_PER_KM, CAR_ONLY, ws, algo);
+    return {res.path, res.cost};
+}
+
+inline pair<vector<int>, double> shortestCarRoute(const Graph& graph, int start, int end) {
+    SearchWorkspace ws;
+    return shortestCarRoute(graph, start, end, ws);
+}
+
+// km of one route step as the search counted it: the edge's own length, or the
+// straight line for a step without an edge of that mode
+inline double stepLength(const Graph& graph, int u, int v, int mode) {
+    double d = graph.frozen ? graph.edgeLength(u, v, mode) : INF;
+    if (d < INF) return d;
+    return haversine(graph.nodes[u].lat, graph.nodes[u].lon, graph.nodes[v].lat, graph.nodes[v].lon);
+}
+
+inline void printRoute(ostream& outFile, const Graph& graph, const CostResult& res, const double costPerKm[]) {
+    STATS(StatTimer timer(PHASE_OUTPUT));
+    if (res.cost < 0) {
+        outFile << "No route found!\n";
+        return;
+    }
+    
+    double totalDist = 0, totalCost = 0;
+    
+    int i = 0;
+    while (i < (int)res.path.size() - 1) {
+        int startNode = res.path[i];
+        int mode = res.modes[i];
+        
+        int j = i;
+        double segDist = 0;
+        while (j < (int)res.path.size() - 1 && res.modes[j] == mode) {
+            segDist += stepLength(graph, res.path[j], res.path[j+1], mode);
+            j++;
+        }
+        
+        int endNode = res.path[j];
+        double segCost = segDist * costPerKm[mode];
+        totalDist += segDist;
+        totalCost += segCost;
+        
+        string action = (mode == 0) ? "Drive Car" : "Ride " + getModeName(mode);
+        outFile << fixed << setprecision(2);
+        outFile << "Cost: Tk " << segCost << ": " << action;
+        outFile << " from (" << fixed << setprecision(6) << graph.nodes[startNode].lon << ", " << graph.nodes[startNode].lat << ")";
+        outFile << " to (" << graph.nodes[endNode].lon << ", " << graph.nodes[endNode].lat << ").\n";
+        
+        i = j;
+    }
+    
+    outFile << "\n";
+    outFile << fixed << setprecision(2);
+    outFile << "Total Distance: " << totalDist << " km\n";
+    outFile << "Total Cost: Tk " << totalCost << "\n";
+}
+
+// Label of the timed searches. A route is the chain of labels through parent, so a
+// relaxation stores one fixed-size label instead of a copy of the route so far.
+struct TimeLabel {
+    double cost;
+    int time;
+    int node;
+    int parent; // label index, -1 at the start
+    int mode;
+};
+
+struct LabelArena {
+    vector<TimeLabel> labels;
+    
+    int add(double cost, int time, int node, int parent, int mode) {
+        labels.push_back({cost, time, node, parent, mode});
+        return labels.size() - 1;
+    }
+    
+    void trace(int label, vector<pair<int,int>>& path, vector<int>& modes) const {
+        path.clear();
+        modes.clear();
+        for (int i = label; i != -1; i = labels[i].parent) {
+            path.push_back({labels[i].node, labels[i].time});
+            if (labels[i].parent != -1) modes.push_back(labels[i].mode);
+        }
+        reverse(path.begin(), path.end());
+        reverse(modes.begin(), modes.end());
+    }
+    
+    // the route ending in label; every label made so far counts as pushed
+    TimeResult result(int label, int settled = 0) const {
+        STATS(StatTimer timer(PHASE_UNPACK));
+        TimeResult res;
+        trace(label, res.pathWithTime, res.modes);
+        res.cost = labels[label].cost;
+        res.arrivalTime = labels[label].time;
+        res.settled = settled;
+        res.pushes = labels.size();
+        return res;
+    }
+};
+
+// min-heap of label indices ordered by (cost, time, node) or, with timeFirst,
+// (time, cost, node); equal keys come out in the order the labels were made
+struct LabelHeap {
+    const LabelArena& arena;
+    bool timeFirst;
+    vector<int> items;
+    
+    LabelHeap(const LabelArena& a, bool byTime) : arena(a), timeFirst(byTime) {}
+    
+    bool after(int a, int b) const {
+        const TimeLabel& x = arena.labels[a];
+        const TimeLabel& y = arena.labels[b];
+        if (timeFirst && x.time != y.time) return x.time > y.time;
+        if (x.cost != y.cost) return x.cost > y.cost;
+        if (x.time != y.time) return x.time > y.time;
+        if (x.node != y.node) return x.node > y.node;
+        return a > b;
+    }
+    
+    bool empty() const { return items.empty(); }
+    
+    void push(int label) {
+        items.push_back(label);
+        push_heap(items.begin(), items.end(), [this](int a, int b) { return after(a, b); });
+        STATS(statMax(STAT_MAX_QUEUE, items.size()));
+    }
+    
+    int pop() {
+        pop_heap(items.begin(), items.end(), [this](int a, int b) { return after(a, b); });
+        int top = items.back();
+        items.pop_back();
+        return top;
+    }
+};
+
+// departure and arrival minute of a timed edge; false if no departure is left today
+inline bool edgeTimes(int mode, double dist, int currTime, const double speeds[], const int intervals[],
+                      const int schedStart[], const int schedEnd[], int& arriveTime) {
+    int travelTime = (int)((dist / speeds[mode]) * 60);
+    
+    int departTime = currTime;
+    if (mode != 0 && intervals[mode] > 0) { // public transport has schedule
+        int dep = nextDeparture(currTime, intervals[mode], schedStart[mode], schedEnd[mode]);
+        if (dep == -1) return false;
+        departTime = dep;
+    }
+    
+    arriveTime = departTime + travelTime;
+    if (travelTime == 0) arriveTime = departTime + 1; // at least 1 min
+    return true;
+}
+
+// Dijkstra's algorithm for cheapest route with time
+inline TimeResult cheapestWithTime(const Graph& graph, int start, int end, int startMins,
+                                   const double costPerKm[], const double speeds[],
+                                   const int intervals[], const int schedStart[], const int schedEnd[], const bool allowed[]) {
+    STATS(StatTimer timer(PHASE_SEARCH));
+    vector<double> bestCost(graph.nodeCount, INF);
+    LabelArena arena;
+    LabelHeap pq(arena, false);
+    pq.push(arena.add(0, startMins, start, -1, 0));
+    int settled = 0;
+    
+    while (!pq.empty()) {
+        int label = pq.pop();
+        double currCost = arena.labels[label].cost;
+        int currTime = arena.labels[label].time;
+        int u = arena.labels[label].node;
+        
+        if (bestCost[u] <= currCost) {
+            STATS(statCount(STAT_STALE));
+            continue;
+        }
+        bestCost[u] = currCost;
+        settled++;
+        STATS(statCount(STAT_SETTLED));
+        
+        if (u == end) return arena.result(label, settled);
+        
+        for (int m = 0; m < NUM_MODES; m++) {
+            if (!allowed[m]) continue;
+            STATS(statCount(STAT_RELAXED, graph.edgeEnd(u, m) - graph.edgeBegin(u, m)));
+            for (int i = graph.edgeBegin(u, m); i < graph.edgeEnd(u, m); i++) {
+                int v = graph.edgeTo[i];
+                int arriveTime;
+                if (!edgeTimes(m, graph.edgeDist[i], currTime, speeds, intervals, schedStart, schedEnd, arriveTime)) continue;
+                double newCost = currCost + graph.edgeDist[i] * costPerKm[m];
+                if (newCost < bestCost[v]) pq.push(arena.add(newCost, arriveTime, v, label, m));
+            }
+        }
+    }
+    
+    return {{}, {}, -1, -1, settled, (int)arena.labels.size()};
+}
+
+// Dijkstra's algorithm for fastest route
+inline TimeResult fastestRoute(const Graph& graph, int start, int end, int startMins,
+                               const double costPerKm[], const double speeds[],
+                               const int intervals[], const int schedStart[], const int schedEnd[], const bool allowed[]) {
+    STATS(StatTimer timer(PHASE_SEARCH));
+    vector<int> bestTime(graph.nodeCount, INT_MAX);
+    LabelArena arena;
+    LabelHeap pq(arena, true);
+    pq.push(arena.add(0, startMins, start, -1, 0));
+    int settled = 0;
+    
+    while (!pq.empty()) {
+        int label = pq.pop();
+        double currCost = arena.labels[label].cost;
+        int currTime = arena.labels[label].time;
+        int u = arena.labels[label].node;
+        
+        if (bestTime[u] <= currTime) {
+            STATS(statCount(STAT_STALE));
+            continue;
+        }
+        bestTime[u] = currTime;
+        settled++;
+        STATS(statCount(STAT_SETTLED));
+        
+        if (u == end) return arena.result(label, settled);
+        
+        for (int m = 0; m < NUM_MODES; m++) {
+            if (!allowed[m]) continue;
+            STATS(statCount(STAT_RELAXED, graph.edgeEnd(u, m) - graph.edgeBegin(u, m)));
+            for (int i = graph.edgeBegin(u, m); i < graph.edgeEnd(u, m); i++) {
+                int v = graph.edgeTo[i];
+                int arriveTime;
+                if (!edgeTimes(m, graph.edgeDist[i], currTime, speeds, intervals, schedStart, schedEnd, arriveTime)) continue;
+                double newCost = currCost + graph.edgeDist[i] * costPerKm[m];
+                if (arriveTime < bestTime[v]) pq.push(arena.add(newCost, arriveTime, v, label, m));
+            }
+        }
+    }
+    
+    return {{}, {}, -1, -1, settled, (int)arena.labels.size()};
+}
+
+// latest minute to be at a node and still leave on a scheduled mode by minute x,
+// INT_MIN if there is none
+inline int latestBoarding(int x, int interval, int schedStart, int schedEnd) {
+    if (x < schedStart) return INT_MIN;
+    x = min(x, schedEnd);
+    if (nextDeparture(x, interval, schedStart, schedEnd) == x) return x;
+    return schedStart + (x - schedStart) / interval * interval;
+}
+
+// Latest minute at which each node can be left and end still reached by deadlineMins,
+// with the edge times of edgeTimes: a search back from end that takes nodes in order of
+// decreasing latest departure, since leaving later never arrives earlier. Times are
+// whole minutes, so the queue is one bucket per minute before the deadline. Nodes that
+// must be left before startMins cannot be used by a route starting then, so the search
+// stops there and leaves them at INT_MIN.
+inline void latestDepartures(const Graph& graph, int end, int startMins, int deadlineMins, const double speeds[],
+                             const int intervals[], const int schedStart[], const int schedEnd[], const bool allowed[],
+                             vector<int>& latest) {
+    latest.assign(graph.nodeCount, INT_MIN);
+    if (deadlineMins < startMins) return;
+    vector<vector<int>> buckets(deadlineMins - startMins + 1); // bucket k: leave at deadlineMins - k
+    latest[end] = deadlineMins;
+    buckets[0].push_back(end);
+    for (size_t k = 0; k < buckets.size(); k++) {
+        int t = deadlineMins - k;
+        for (size_t j = 0; j < buckets[k].size(); j++) {
+            int w = buckets[k][j];
+            if (latest[w] != t) continue;
+            for (int m = 0; m < NUM_MODES; m++) {
+                if (!allowed[m]) continue;
+                for (int i = graph.edgeBegin(w, m); i < graph.edgeEnd(w, m); i++) {
+                    int v = graph.edgeTo[i]; // edges are stored both ways, so this is also v -> w
+                    int travelTime = max(1, (int)((graph.edgeDist[i] / speeds[m]) * 60));
+                    int leave = t - travelTime;
+                    if (m != 0 && intervals[m] > 0) leave = latestBoarding(leave, intervals[m], schedStart[m], schedEnd[m]);
+                    if (leave > latest[v] && leave >= startMins) {
+                        latest[v] = leave;
+                        buckets[deadlineMins - leave].push_back(v);
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Dijkstra's algorithm for cheapest route with deadline constraint. Labels come out in
+// order of cost and a node keeps taking them while each arrives earlier than the ones
+// it took before: a later, dearer label can never leave sooner, so it is dominated,
+// while a cheaper one that is too late no longer blocks an earlier one. The first
+// label taken at end is the cheapest route in time. Labels that can no longer reach
+// end by the deadline (see latestDepartures) are never created.
+inline TimeResult cheapestWithDeadline(const Graph& graph, int start, int end, int startMins, int deadlineMins,
+                                       const double costPerKm[], const double speeds[],
+                                       const int intervals[], const int schedStart[], const int schedEnd[], const bool allowed[]) {
+    STATS(StatTimer timer(PHASE_SEARCH));
+    vector<int> latest;
+    latestDepartures(graph, end, startMins, deadlineMins, speeds, intervals, schedStart, schedEnd, allowed, latest);
+    if (latest[start] < startMins) return {{}, {}, -1, -1};
+    
+    vector<int> bestTime(graph.nodeCount, INT_MAX); // earliest arrival of the labels taken
+    LabelArena arena;
+    LabelHeap pq(arena, false);
+    pq.push(arena.add(0, startMins, start, -1, 0));
+    int settled = 0;
+    
+    while (!pq.empty()) {
+        int label = pq.pop();
+        double currCost = arena.labels[label].cost;
+        int currTime = arena.labels[label].time;
+        int u = arena.labels[label].node;
+        
+        if (bestTime[u] <= currTime) {
+            STATS(statCount(STAT_STALE));
+            continue;
+        }
+        bestTime[u] = currTime;
+        settled++;
+        STATS(statCount(STAT_SETTLED));
+        
+        if (u == end) return arena.result(label, settled);
+        
+        for (int m = 0; m < NUM_MODES; m++) {
+            if (!allowed[m]) continue;
+            STATS(statCount(STAT_RELAXED, graph.edgeEnd(u, m) - graph.edgeBegin(u, m)));
+            for (int i = graph.edgeBegin(u, m); i < graph.edgeEnd(u, m); i++) {
+                int v = graph.edgeTo[i];
+                int arriveTime;
+                if (!edgeTimes(m, graph.edgeDist[i], currTime, speeds, intervals, schedStart, schedEnd, arriveTime)) continue;
+                if (arriveTime > latest[v] || arriveTime >= bestTime[v]) continue;
+                double newCost = currCost + graph.edgeDist[i] * costPerKm[m];
+                pq.push(arena.add(newCost, arriveTime, v, label, m));
+            }
+        }
+    }
+    
+    return {{}, {}, -1, -1, settled, (int)arena.labels.size()};
+}
+
+inline void printTimedRoute(ostream& outFile, const Graph& graph, const TimeResult& res, const double costPerKm[],
+                            string noRouteMsg = "No route found!") {
+    STATS(StatTimer timer(PHASE_OUTPUT));
+    if (res.cost < 0) {
+        outFile << noRouteMsg << "\n";
+        return;
+    }
+    
+    double totalCost = 0;
+    
+    int i = 0;
+    while (i < (int)res.pathWithTime.size() - 1) {
+        int startNode = res.pathWithTime[i].first;
+        int startT = res.pathWithTime[i].second;
+        int mode = res.modes[i];
+        
+        int j = i;
+        double segDist = 0;
+        while (j < (int)res.pathWithTime.size() - 1 && j < (int)res.modes.size() && res.modes[j] == mode) {
+            segDist += stepLength(graph, res.pathWithTime[j].first, res.pathWithTime[j+1].first, mode);
+            j++;
+        }
+        
+        int endNode = res.pathWithTime[j].first;
+        int endT = res.pathWithTime[j].second;
+        double segCost = segDist * costPerKm[mode];
+        totalCost += segCost;
+        
+        string action;
+        if (mode == 0) action = "Ride Car";
+        else if (mode == 1) action = "Ride Metro";
+        else if (mode == 2) action = "Ride Bikolpo Bus";
+        else action = "Ride Uttara Bus";
+        
+        outFile << minsToTime(startT) << " - " << minsToTime(endT);
+        outFile << ", Cost: Tk " << fixed << setprecision(2) << segCost << ": " << action;
+        outFile << " from (" << fixed << setprecision(6) << graph.nodes[startNode].lon << ", " << graph.nodes[startNode].lat << ")";
+        outFile << " to (" << graph.nodes[endNode].lon << ", " << graph.nodes[endNode].lat << ").\n";
+        
+        i = j;
+    }
+    
+    outFile << "\n";
+    outFile << fixed << setprecision(2);
+    outFile << "Total Cost: Tk " << totalCost << "\n";
+}
+
+#endif // ROUTING_H
@@ -0,0 +1,246 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "graph.h"
+#include <cstdint>
+#include <cstdio>
+#include <sys/stat.h>
+
+// Binary snapshot of a frozen Graph.
+//
+// Layout: SnapshotHeader, then 8-byte aligned sections
+//   lat[n], lon[n] (double), isStop[n] (uint8), nameStart[n+1] (uint32), name bytes,
+//   edgeStart[n*NUM_MODES+1], edgeTo[m] (int32), edgeDist[m] (double)
+// Coordinates and lengths are written at full precision in either storage mode, so
+// a COMPACT_GRAPH build reads the snapshots of a normal one and the other way round.
+// The header carries a stamp of the source CSV files and a checksum of the payload,
+// so a snapshot built from other data (or a truncated file) is rejected.
+
+const uint32_t SNAPSHOT_VERSION = 2;
+const uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint64_t sourceStamp;
+    uint64_t checksum;
+    uint64_t payloadBytes;
+    int32_t nodeCount;
+    int32_t edgeCount;
+    int32_t numModes;
+    int32_t reserved;
+};
+
+// input file of a graph; mode 0 is loaded with loadRoads, others with loadTransport
+struct GraphSource {
+    string file;
+    int mode;
+};
+
+inline uint64_t fnv1a(const void* data, size_t len, uint64_t h = 1469598103934665603ULL) {
+    const unsigned char* p = (const unsigned char*)data;
+    for (size_t i = 0; i < len; i++) {
+        h ^= p[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+// word-at-a-time checksum for the payload (byte FNV is too slow for megabytes)
+inline uint64_t payloadChecksum(const char* data, size_t len) {
+    uint64_t h = 1469598103934665603ULL;
+    size_t words = len / 8;
+    for (size_t i = 0; i < words; i++) {
+        uint64_t w;
+        memcpy(&w, data + i * 8, 8);
+        h = (h ^ w) * 1099511628211ULL;
+        h ^= h >> 29;
+    }
+    return fnv1a(data + words * 8, len - words * 8, h);
+}
+
+// identifies the exact CSV inputs: path, mode, size and modification time of each
+inline uint64_t sourceStamp(const vector<GraphSource>& sources) {
+    uint64_t h = fnv1a(&SNAPSHOT_VERSION, sizeof(SNAPSHOT_VERSION));
+    for (auto& src : sources) {
+        struct stat st;
+        if (stat(src.file.c_str(), &st) != 0) return 0;
+        int64_t fields[3] = {(int64_t)src.mode, (int64_t)st.st_size, (int64_t)st.st_mtime};
+        h = fnv1a(src.file.data(), src.file.size(), h);
+        h = fnv1a(fields, sizeof(fields), h);
+    }
+    return h;
+}
+
+inline size_t alignSection(size_t bytes) { return (bytes + 7) & ~(size_t)7; }
+
+inline void appendSection(string& buf, const void* data, size_t bytes) {
+    buf.append((const char*)data, bytes);
+    buf.append(alignSection(bytes) - bytes, '\0');
+}
+
+// write a frozen graph; returns false if the file could not be written
+inline bool saveSnapshot(Graph& graph, const string& filename, uint64_t stamp) {
+    if (!graph.frozen) return false;
+    int n = graph.nodeCount;
+    int m = (int)graph.edgeTo.size();
+    
+    vector<double> lats(n), lons(n);
+    vector<unsigned char> stops(n);
+    vector<uint32_t> nameStart(n + 1, 0);
+    string names;
+    vector<double> dists(m);
+    for (int i = 0; i < n; i++) {
+        lats[i] = graph.nodes[i].lat;
+        lons[i] = graph.nodes[i].lon;
+        stops[i] = graph.nodes[i].isStop;
+        names += graph.nodeName(i);
+        nameStart[i + 1] = (uint32_t)names.size();
+        for (int j = graph.edgeBegin(i, 0); j < graph.edgeEnd(i, NUM_MODES - 1); j++) dists[j] = graph.exactLength(i, j);
+    }
+    
+    string payload;
+    appendSection(payload, lats.data(), n * sizeof(double));
+    appendSection(payload, lons.data(), n * sizeof(double));
+    appendSection(payload, stops.data(), n);
+    appendSection(payload, nameStart.data(), (n + 1) * sizeof(uint32_t));
+    appendSection(payload, names.data(), names.size());
+    appendSection(payload, graph.edgeStart.data(), graph.edgeStart.size() * sizeof(int));
+    appendSection(payload, graph.edgeTo.data(), m * sizeof(int));
+    appendSection(payload, dists.data(), m * sizeof(double));
+    
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "GRPHSNAP", 8);
+    header.version = SNAPSHOT_VERSION;
+    header.byteOrder = SNAPSHOT_BYTE_ORDER;
+    header.sourceStamp = stamp;
+    header.checksum = payloadChecksum(payload.data(), payload.size());
+    header.payloadBytes = payload.size();
+    header.nodeCount = n;
+    header.edgeCount = m;
+    header.numModes = NUM_MODES;
+    
+    // write to a temp file and rename so a concurrent reader never sees a partial snapshot
+    string tmp = filename + ".tmp";
+    ofstream file(tmp, ios::binary);
+    if (!file) return false;
+    file.write((const char*)&header, sizeof(header));
+    file.write(payload.data(), payload.size());
+    file.close();
+    if (!file) {
+        remove(tmp.c_str());
+        return false;
+    }
+    return rename(tmp.c_str(), filename.c_str()) == 0;
+}
+
+// map a snapshot read-only and copy its sections into an empty graph;
+// returns false (leaving the graph empty) if it is missing, stale or corrupt
+inline bool loadSnapshot(Graph& graph, const string& filename, uint64_t stamp) {
+    MappedFile file(filename);
+    if (file.size < sizeof(SnapshotHeader)) return false;
+    size_t size = file.size;
+    
+    SnapshotHeader header;
+    memcpy(&header, file.data, sizeof(header));
+    const char* payload = file.data + sizeof(header);
+    
+    bool ok = memcmp(header.magic, "GRPHSNAP", 8) == 0 &&
+              header.version == SNAPSHOT_VERSION &&
+              header.byteOrder == SNAPSHOT_BYTE_ORDER &&
+              header.numModes == NUM_MODES &&
+              header.sourceStamp == stamp && stamp != 0 &&
+              header.payloadBytes == size - sizeof(header) &&
+              header.nodeCount >= 0 && header.edgeCount >= 0 &&
+              payloadChecksum(payload, header.payloadBytes) == header.checksum;
+    
+    // the counts must describe exactly the payload we have before any section is touched
+    if (ok) {
+        size_t n = header.nodeCount, m = header.edgeCount;
+        size_t fixedBytes = 2 * alignSection(n * sizeof(double)) + alignSection(n) + alignSection((n + 1) * sizeof(uint32_t));
+        size_t edgeBytes = alignSection((n * NUM_MODES + 1) * sizeof(int)) + alignSection(m * sizeof(int)) +
+                           alignSection(m * sizeof(double));
+        ok = fixedBytes + edgeBytes <= header.payloadBytes;
+        if (ok) {
+            uint32_t nameBytes;
+            memcpy(&nameBytes, payload + fixedBytes - alignSection((n + 1) * sizeof(uint32_t)) + n * sizeof(uint32_t), sizeof(nameBytes));
+            ok = fixedBytes + alignSection(nameBytes) + edgeBytes == header.payloadBytes;
+        }
+    }
+    
+    if (ok) {
+        int n = header.nodeCount;
+        int m = header.edgeCount;
+        size_t pos = 0;
+        auto section = [&](size_t bytes) {
+            const char* p = payload + pos;
+            pos += alignSection(bytes);
+            return p;
+        };
+        
+        const double* lats = (const double*)section(n * sizeof(double));
+        const double* lons = (const double*)section(n * sizeof(double));
+        const unsigned char* stops = (const unsigned char*)section(n);
+        const uint32_t* nameStart = (const uint32_t*)section((n + 1) * sizeof(uint32_t));
+        const char* names = section(nameStart[n]);
+        size_t startCount = (size_t)n * NUM_MODES + 1;
+        const int* edgeStart = (const int*)section(startCount * sizeof(int));
+        const int* edgeTo = (const int*)section(m * sizeof(int));
+        const double* edgeDist = (const double*)section(m * sizeof(double));
+        
+        // the checksum only catches damage after writing: the offsets must also stay
+        // in range, as every search indexes with them unchecked
+        ok = nameStart[0] == 0 && edgeStart[0] == 0 && edgeStart[startCount - 1] == m;
+        for (int i = 0; ok && i < n; i++) ok = nameStart[i] <= nameStart[i + 1];
+        for (size_t i = 0; ok && i + 1 < startCount; i++) ok = edgeStart[i] <= edgeStart[i + 1];
+        for (int j = 0; ok && j < m; j++) ok = edgeTo[j] >= 0 && edgeTo[j] < n;
+        if (!ok) return false;
+        
+        graph.nodes.resize(n);
+        for (int i = 0; i < n; i++) {
+            Node& node = graph.nodes[i];
+            node.lat = lats[i];
+            node.lon = lons[i];
+            node.isStop = stops[i];
+            if (nameStart[i + 1] > nameStart[i]) graph.setNodeName(i, string(names + nameStart[i], nameStart[i + 1] - nameStart[i]));
+        }
+        graph.nodeCount = n;
+        
+        graph.edgeStart.assign(edgeStart, edgeStart + startCount);
+        graph.edgeTo.assign(edgeTo, edgeTo + m);
+        graph.edgeDist.resize(m);
+        graph.exactDist.clear();
+        for (int i = 0; i < n; i++) {
+            for (int j = edgeStart[i * NUM_MODES]; j < edgeStart[(i + 1) * NUM_MODES]; j++) graph.setLength(i, j, edgeDist[j]);
+        }
+        graph.adj.clear();
+        graph.frozen = true;
+        graph.indexDirty = true;
+        
+        graph.nodeMap.clear();
+        graph.nodeMap.reserve(n);
+        bool inserted;
+        for (int i = 0; i < n; i++) graph.nodeMap.findOrInsert(makeKey(lats[i], lons[i]), i, inserted);
+    }
+    
+    return ok;
+}
+
+// load a frozen graph from the snapshot if it matches the sources, otherwise parse
+// the CSVs and refresh the snapshot; returns true when the snapshot was used
+inline bool loadGraph(Graph& graph, const vector<GraphSource>& sources, const string& snapshotFile) {
+    uint64_t stamp = sourceStamp(sources);
+    if (loadSnapshot(graph, snapshotFile, stamp)) return true;
+    
+    for (auto& src : sources) {
+        if (src.mode == 0) loadRoads(graph, src.file);
+        else loadTransport(graph, src.file, src.mode);
+    }
+    graph.freeze();
+    if (stamp != 0) saveSnapshot(graph, snapshotFile, stamp);
+    return false;
+}
+
+#endif // SNAPSHOT_H
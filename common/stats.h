@@ -0,0 +1,177 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+using namespace std;
+
+// Opt-in search statistics. Build with -DROUTE_STATS to collect them; without it every
+// STATS(...) statement expands to nothing, so the searches carry no counters or timers.
+//
+// Each thread keeps one QueryStats record for the query it is answering:
+//   settled    nodes (or labels) taken off the queue and expanded
+//   relaxed    edges looked at from them
+//   stale      queue entries popped after their node had been reached more cheaply
+//   max queue  largest number of entries in the queue (not kept by the Pareto search,
+//              whose labels wait in time buckets)
+// and the time in each phase: snapping the endpoints, the search, unpacking the route
+// and writing output. Phases nest without double counting: an inner phase (unpacking
+// inside the search) is taken out of the outer one. endQueryStats adds the record to
+// log2 histograms shared by all threads, which dumpStats prints.
+
+#ifdef ROUTE_STATS
+#define STATS(statement) statement
+#else
+#define STATS(statement)
+#endif
+
+enum StatCounter { STAT_SETTLED, STAT_RELAXED, STAT_STALE, STAT_MAX_QUEUE, NUM_COUNTERS };
+enum StatPhase { PHASE_SNAP, PHASE_SEARCH, PHASE_UNPACK, PHASE_OUTPUT, NUM_PHASES };
+
+inline const char* counterName(int counter) {
+    static const char* names[NUM_COUNTERS] = {"settled", "relaxed", "stale", "max queue"};
+    return names[counter];
+}
+
+inline const char* phaseName(int phase) {
+    static const char* names[NUM_PHASES] = {"snap", "search", "unpack", "output"};
+    return names[phase];
+}
+
+struct QueryStats {
+    long long counters[NUM_COUNTERS] = {};
+    double ms[NUM_PHASES] = {};
+};
+
+// the record of the query this thread is answering
+inline QueryStats& threadStats() {
+    thread_local QueryStats stats;
+    return stats;
+}
+
+inline void statCount(int counter, long long n = 1) { threadStats().counters[counter] += n; }
+
+inline void statMax(int counter, long long value) {
+    long long& c = threadStats().counters[counter];
+    if (value > c) c = value;
+}
+
+// adds the time from construction to destruction to a phase, less the time of the
+// timers started inside it
+class StatTimer {
+public:
+    explicit StatTimer(int phase) : phase(phase), parent(current()), t0(chrono::steady_clock::now()) {
+        current() = this;
+    }
+    
+    ~StatTimer() {
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+        threadStats().ms[phase] += ms - nestedMs;
+        if (parent) parent->nestedMs += ms;
+        current() = parent;
+    }
+    
+    StatTimer(const StatTimer&) = delete;
+    StatTimer& operator=(const StatTimer&) = delete;
+
+private:
+    int phase;
+    StatTimer* parent;
+    chrono::steady_clock::time_point t0;
+    double nestedMs = 0;
+    
+    static StatTimer*& current() {
+        thread_local StatTimer* innermost = nullptr;
+        return innermost;
+    }
+};
+
+// counts of values in power-of-two buckets: bucket 0 holds values below 1, bucket b
+// values in [2^(b-1), 2^b)
+struct StatHistogram {
+    long long count = 0;
+    double sum = 0, largest = 0;
+    long long buckets[64] = {};
+    
+    void add(double value) {
+        int b = value < 1 ? 0 : min(63, 1 + (int)log2(value));
+        buckets[b]++;
+        count++;
+        sum += value;
+        largest = max(largest, value);
+    }
+    
+    // one line with the mean and largest value, then one bar per non-empty bucket;
+    // values are divided by scale for printing
+    void print(ostream& out, const string& title, double scale, const string& unit) const {
+        out << title << ": " << count << " queries, mean " << sum / max(1LL, count) / scale << unit << ", max "
+            << largest / scale << unit << "\n";
+        long long most = 1;
+        for (long long n : buckets) most = max(most, n);
+        for (int b = 0; b < 64; b++) {
+            if (buckets[b] == 0) continue;
+            double lo = b == 0 ? 0 : ldexp(1.0, b - 1) / scale, hi = ldexp(1.0, b) / scale;
+            stringstream range;
+            range << "[" << lo << ", " << hi << ")";
+            out << "  " << left << setw(22) << range.str() << right << setw(8) << buckets[b] << " "
+                << string((buckets[b] * 40 + most - 1) / most, '#') << "\n";
+        }
+    }
+};
+
+// histograms of all queries answered so far, over all threads
+struct StatsSummary {
+    long long queries = 0;
+    StatHistogram counters[NUM_COUNTERS];
+    StatHistogram phases[NUM_PHASES]; // microseconds
+    mutex mtx;
+};
+
+inline StatsSummary& statsSummary() {
+    static StatsSummary summary;
+    return summary;
+}
+
+// start a new record for this thread's next query
+inline void beginQueryStats() { threadStats() = QueryStats(); }
+
+// add this thread's record to the summary. Counters count only for records with a
+// search and phases only where they took time, so a record that holds just the output
+// of an answer searched elsewhere (batch mode) adds to the output histogram alone.
+inline void endQueryStats() {
+    const QueryStats& s = threadStats();
+    StatsSummary& summary = statsSummary();
+    lock_guard<mutex> lock(summary.mtx);
+    summary.queries++;
+    if (s.ms[PHASE_SEARCH] > 0) {
+        for (int c = 0; c < NUM_COUNTERS; c++) summary.counters[c].add(s.counters[c]);
+    }
+    for (int p = 0; p < NUM_PHASES; p++) {
+        if (s.ms[p] > 0) summary.phases[p].add(s.ms[p] * 1000);
+    }
+}
+
+// one line for a record: counters, then milliseconds per phase
+inline string formatStats(const QueryStats& s) {
+    stringstream ss;
+    for (int c = 0; c < NUM_COUNTERS; c++) ss << (c ? ", " : "") << counterName(c) << " " << s.counters[c];
+    ss << fixed << setprecision(3);
+    for (int p = 0; p < NUM_PHASES; p++) ss << ", " << phaseName(p) << " " << s.ms[p] << " ms";
+    return ss.str();
+}
+
+inline void dumpStats(ostream& out) {
+    StatsSummary& summary = statsSummary();
+    lock_guard<mutex> lock(summary.mtx);
+    out << "Search statistics over " << summary.queries << " records\n";
+    for (int c = 0; c < NUM_COUNTERS; c++) summary.counters[c].print(out, counterName(c), 1, "");
+    for (int p = 0; p < NUM_PHASES; p++) summary.phases[p].print(out, string(phaseName(p)) + " time", 1000, " ms");
+}
+
+#endif // STATS_H
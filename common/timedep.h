@@ -0,0 +1,117 @@
+#ifndef TIMEDEP_H
+#define TIMEDEP_H
+
+#include "routing.h"
+
+// Time-dependent earliest arrival with vehicle trips.
+//
+// fastestRoute waits for a fresh departure at every vertex of a transit polyline and
+// rounds each tiny segment to whole minutes (at least one). Here a search state is a
+// node plus the transit mode being ridden (0 = not on board): boarding waits once for
+// the next departure of the mode's schedule, riding on along edges of the same mode
+// costs only travel time, and getting off is free. Times are fractional minutes.
+// Departures are the same for every node of a mode (intervals / schedStart / schedEnd),
+// so travel times never let a later start arrive earlier and Dijkstra on time is exact.
+// The graph does not tell lines of one mode apart, so staying on board where two lines
+// of the same mode meet counts as one trip.
+
+struct TimeDepResult {
+    vector<int> path;
+    vector<int> modes;
+    vector<double> times; // arrival minute at each path node
+    double cost = -1;
+    double arrivalTime = -1;
+    int boardings = 0;
+    int settled = 0;
+};
+
+const int TD_ALIGHT = 255; // parentMode of a get-off step, which stays on the node
+
+// first departure at or after the fractional minute t, -1 if none is left
+inline int departureAfter(double t, int interval, int schedStart, int schedEnd) {
+    return nextDeparture((int)ceil(t - 1e-9), interval, schedStart, schedEnd);
+}
+
+inline TimeDepResult earliestArrival(const Graph& graph, int start, int end, double startMins,
+                                     const double costPerKm[], const double speeds[], const int intervals[],
+                                     const int schedStart[], const int schedEnd[], const bool allowed[],
+                                     SearchWorkspace& ws) {
+    STATS(StatTimer timer(PHASE_SEARCH));
+    TimeDepResult res;
+    auto state = [](int node, int onBoard) { return node * NUM_MODES + onBoard; };
+    ws.reset(graph.nodeCount * NUM_MODES);
+    ws.set(state(start, 0), startMins, -1, 0);
+    ws.push(startMins, state(start, 0));
+    
+    auto relax = [&](int from, int to, double t, int mode) {
+        STATS(statCount(STAT_RELAXED));
+        if (t < ws.get(to)) {
+            ws.set(to, t, from, mode);
+            ws.push(t, to);
+        }
+    };
+    
+    int found = -1;
+    while (!ws.empty()) {
+        auto [t, s] = ws.pop();
+        if (t > ws.dist[s]) {
+            STATS(statCount(STAT_STALE));
+            continue;
+        }
+        res.settled++;
+        STATS(statCount(STAT_SETTLED));
+        int u = s / NUM_MODES, onBoard = s % NUM_MODES;
+        if (u == end && onBoard == 0) {
+            found = s;
+            break;
+        }
+        
+        if (onBoard != 0) {
+            relax(s, state(u, 0), t, TD_ALIGHT);
+            for (int i = graph.edgeBegin(u, onBoard); i < graph.edgeEnd(u, onBoard); i++) {
+                relax(s, state(graph.edgeTo[i], onBoard), t + graph.edgeDist[i] / speeds[onBoard] * 60, onBoard);
+            }
+            continue;
+        }
+        
+        for (int m = 0; m < NUM_MODES; m++) {
+            if (!allowed[m]) continue;
+            bool scheduled = m != 0 && intervals[m] > 0;
+            double depart = t;
+            if (scheduled) {
+                int dep = departureAfter(t, intervals[m], schedStart[m], schedEnd[m]);
+                if (dep == -1) continue;
+                depart = dep;
+            }
+            for (int i = graph.edgeBegin(u, m); i < graph.edgeEnd(u, m); i++) {
+                relax(s, state(graph.edgeTo[i], scheduled ? m : 0), depart + graph.edgeDist[i] / speeds[m] * 60, m);
+            }
+        }
+    }
+    
+    if (found < 0) return res;
+    
+    // walk back over the states; get-off steps add no node
+    STATS(StatTimer unpackTimer(PHASE_UNPACK));
+    for (int s = found; s != -1; s = ws.parent[s]) {
+        int p = ws.parent[s];
+        if (p != -1 && ws.parentMode[s] == TD_ALIGHT) continue;
+        if (p != -1 && p % NUM_MODES == 0 && s % NUM_MODES != 0) res.boardings++;
+        res.path.push_back(s / NUM_MODES);
+        res.times.push_back(ws.dist[s]);
+        if (ws.parent[s] != -1) res.modes.push_back(ws.parentMode[s]);
+    }
+    reverse(res.path.begin(), res.path.end());
+    reverse(res.times.begin(), res.times.end());
+    reverse(res.modes.begin(), res.modes.end());
+    
+    res.cost = 0;
+    for (size_t k = 0; k < res.modes.size(); k++) {
+        int m = res.modes[k];
+        res.cost += graph.edgeLength(res.path[k], res.path[k + 1], m) * costPerKm[m];
+    }
+    res.arrivalTime = res.times.back();
+    return res;
+}
+
+#endif // TIMEDEP_H
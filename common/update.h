@@ -0,0 +1,208 @@
+#ifndef UPDATE_H
+#define UPDATE_H
+
+#include "cache.h"
+#include "crp.h"
+#include <atomic>
+#include <thread>
+
+// Live updates for road closures and congestion. A batch of closures, reopenings and
+// length factors is applied to a frozen graph between queries (Graph::closeEdge and
+// friends), then GraphUpdater brings what was derived from the graph up to date:
+//   query cache          drops the answers and trees that use a changed edge when
+//                        nothing got shorter, else empties (QueryCache::edgesChanged)
+//   CRP metrics          recompute the cliques of the cells around a changed edge
+//   transit network      recomputes the rows of its car table with a route over a
+//                        changed road (all rows if one got shorter), or is rebuilt
+//                        when a transit edge changed (TransitNetwork::edgesChanged)
+//   compressed graph     walks the chains through or next to a changed edge again
+//                        (CompressedGraph::update)
+//   contraction hierarchy  emptied on a car change: its shortcuts were chosen by witness
+//                        searches over the old lengths and cannot be repaired in place,
+//                        so its owner rebuilds it off the query thread (CHRebuilder);
+//                        until then car queries use the CRP metric, or the plain search
+// The spatial grids and the node index need nothing: no node moves or disappears, and
+// snapping skips a node once all its edges of the wanted modes are closed
+// (Graph::closedOff).
+//
+// Text form, one change per line; A and B are a node as "lon lat" (the CSV
+// coordinates) or as "#id", and the mode is a word of its name, car by default:
+//   close  A B [mode]      close the A-B edges of the mode, both ways
+//   reopen A B [mode]      open them again
+//   factor A B F [mode]    make them F times their loaded length, F >= 1 (1 restores)
+
+enum UpdateKind { UPDATE_CLOSE, UPDATE_REOPEN, UPDATE_FACTOR };
+
+struct EdgeUpdate {
+    int kind = UPDATE_CLOSE;
+    int u = -1, v = -1; // node ids
+    int mode = 0;
+    double factor = 1;  // UPDATE_FACTOR only
+};
+
+// true if the line starts with an update word rather than a query type
+inline bool isUpdateLine(const string& line) {
+    stringstream ss(line);
+    string word;
+    ss >> word;
+    return word == "close" || word == "reopen" || word == "factor";
+}
+
+// parse one update line; returns false with a message on malformed input or an
+// unknown node
+inline bool parseUpdate(const Graph& graph, const string& line, EdgeUpdate& up, string& error) {
+    stringstream ss(line);
+    string word;
+    ss >> word;
+    up = EdgeUpdate();
+    up.kind = word == "close" ? UPDATE_CLOSE : word == "reopen" ? UPDATE_REOPEN : UPDATE_FACTOR;
+    
+    auto readNode = [&](int& id) {
+        string tok;
+        if (!(ss >> tok)) return false;
+        if (tok[0] == '#') {
+            const char* end = tok.data() + tok.size();
+            auto res = from_chars(tok.data() + 1, end, id);
+            return res.ec == errc() && res.ptr == end && id >= 0 && id < graph.nodeCount;
+        }
+        double lon, lat;
+        if (!parseDouble(tok, lon) || !(ss >> lat)) return false;
+        id = graph.nodeMap.find(makeKey(lat, lon));
+        return id >= 0;
+    };
+    if (!readNode(up.u) || !readNode(up.v)) {
+        error = "expected two nodes as lon lat or #id";
+        return false;
+    }
+    if (up.kind == UPDATE_FACTOR && !(ss >> up.factor && up.factor >= 1)) {
+        error = "expected a length factor of at least 1";
+        return false;
+    }
+    string mode;
+    if (ss >> mode) {
+        up.mode = modeByName(mode);
+        if (up.mode < 0) {
+            error = "unknown mode '" + mode + "'";
+            return false;
+        }
+    }
+    return true;
+}
+
+// what one batch changed and what had to follow
+struct UpdateResult {
+    int changed = 0;          // updates that changed at least one edge
+    int slots = 0;            // directed edge slots changed
+    bool onlyLonger = true;   // no length went down and nothing reopened
+    int cells = 0;            // CRP cells recomputed over all metrics
+    long long dropped = 0;    // cache entries dropped
+    bool chCleared = false;
+    int transitRows = 0;      // rows of the transit car table recomputed
+    int chains = 0;           // compressed chains walked again
+    double graphMs = 0, dependentMs = 0;
+};
+
+class GraphUpdater {
+public:
+    Graph& graph;
+    QueryCache* cache = nullptr;
+    ContractionHierarchy* ch = nullptr;
+    TransitNetwork* transit = nullptr; // rebuilt only once it has been built
+    CompressedGraph* compressed = nullptr;
+    vector<CRPMetric*> metrics;
+    
+    explicit GraphUpdater(Graph& graph) : graph(graph) {}
+    
+    // apply the updates in order, then update the dependent structures once
+    UpdateResult apply(const vector<EdgeUpdate>& batch) {
+        UpdateResult res;
+        auto t0 = chrono::steady_clock::now();
+        vector<array<int,3>> steps;
+        int modes = 0;
+        for (const EdgeUpdate& up : batch) {
+            double before = graph.frozen ? graph.edgeLength(up.u, up.v, up.mode) : INF;
+            int n = 0;
+            if (up.kind == UPDATE_CLOSE) n = graph.closeEdge(up.u, up.v, up.mode);
+            else if (up.kind == UPDATE_REOPEN) n = graph.reopenEdge(up.u, up.v, up.mode);
+            else n = graph.scaleEdge(up.u, up.v, up.mode, max(1.0, up.factor));
+            if (n == 0) continue;
+            res.changed++;
+            res.slots += n;
+            if (up.kind == UPDATE_REOPEN || graph.edgeLength(up.u, up.v, up.mode) < before) res.onlyLonger = false;
+            steps.push_back({up.u, up.v, up.mode});
+            modes |= modeBit(up.mode);
+        }
+        auto t1 = chrono::steady_clock::now();
+        res.graphMs = chrono::duration<double, milli>(t1 - t0).count();
+        if (steps.empty()) return res;
+        
+        if (cache) {
+            size_t entries = cache->entries();
+            cache->edgesChanged(graph, steps, res.onlyLonger);
+            res.dropped = entries - cache->entries();
+        }
+        for (CRPMetric* metric : metrics) res.cells += metric->recustomize(steps);
+        if (compressed) res.chains = compressed->update(graph, steps);
+        if (ch && !ch->empty() && (modes & modeBit(0))) {
+            *ch = ContractionHierarchy();
+            res.chCleared = true;
+        }
+        if (transit && transit->stopCount() > 0) res.transitRows = transit->edgesChanged(graph, steps, res.onlyLonger);
+        res.dependentMs = chrono::duration<double, milli>(chrono::steady_clock::now() - t1).count();
+        return res;
+    }
+};
+
+// Builds a contraction hierarchy on a thread of its own, from a copy of the car edges
+// taken when it starts, so queries go on while it runs. take() hands the result over
+// once it is done, or starts over if a car edge changed in the meantime.
+class CHRebuilder {
+public:
+    ~CHRebuilder() {
+        if (worker.joinable()) worker.join();
+    }
+    
+    bool running() const { return worker.joinable(); }
+    
+    // no-op while a build runs: take() notices the edges it missed
+    void start(const Graph& graph) {
+        if (running()) return;
+        source.nodeCount = graph.nodeCount;
+        source.frozen = true;
+        source.edgeStart = graph.edgeStart;
+        source.edgeTo = graph.edgeTo;
+        source.edgeDist = graph.edgeDist;
+        done = false;
+        t0 = chrono::steady_clock::now();
+        worker = thread([this]() {
+            built.build(source);
+            done = true;
+        });
+    }
+    
+    // true with the new hierarchy in ch if the build is done and graph's car edges
+    // are still the ones it was built from; ms is the time since the first start
+    bool take(ContractionHierarchy& ch, const Graph& graph, double& ms) {
+        if (!running() || !done) return false;
+        worker.join();
+        if (built.graphStamp != carGraphStamp(graph)) {
+            auto first = t0;
+            start(graph);
+            t0 = first;
+            return false;
+        }
+        ms = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+        ch = move(built);
+        built = ContractionHierarchy();
+        return true;
+    }
+
+private:
+    Graph source; // car edges only matter; the rest stays empty
+    ContractionHierarchy built;
+    thread worker;
+    atomic<bool> done{false};
+    chrono::steady_clock::time_point t0;
+};
+
+#endif // UPDATE_H
@@ -1,49 +1,16 @@
 // Problem 1: Shortest Distance (Car Only)
-#include "../common/graph.h"
+#include "../common/routing.h"
+#include "../common/snapshot.h"
 
 Graph graph;
 
-// Dijkstra's algorithm for shortest car route
-pair<vector<int>, double> shortestCarRoute(int start, int end) {
-    int n = graph.nodeCount;
-    vector<double> dist(n, INF);
-    vector<int> parent(n, -1);
-    priority_queue<pair<double,int>, vector<pair<double,int>>, greater<pair<double,int>>> pq;
-    
-    dist[start] = 0;
-    pq.push({0, start});
-    
-    while (!pq.empty()) {
-        auto [d, u] = pq.top();
-        pq.pop();
-        
-        if (d > dist[u]) continue;
-        if (u == end) break;
-        
-        for (auto& e : graph.adj[u]) {
-            if (e.mode != 0) continue; // car only
-            double newDist = dist[u] + e.dist;
-            if (newDist < dist[e.to]) {
-                dist[e.to] = newDist;
-                parent[e.to] = u;
-                pq.push({newDist, e.to});
-            }
-        }
-    }
-    
-    if (dist[end] >= INF) return {{}, -1};
-    
-    vector<int> path;
-    for (int v = end; v != -1; v = parent[v]) path.push_back(v);
-    reverse(path.begin(), path.end());
-    return {path, dist[end]};
-}
-
 int main() {
     string basePath = "/media/nym/Nym_s Files/grph-project/";
     
     cout << "Loading road data for Problem 1...\n";
-    loadRoads(graph, basePath + "Roadmap-Dhaka.csv");
+    loadGraph(graph, {
+        {basePath + "Roadmap-Dhaka.csv", 0}
+    }, basePath + "problem1/graph.snap");
     cout << "Loaded " << graph.nodeCount << " nodes\n\n";
     
     // Test inputs from dataset (actual coordinates from road/transport data)
@@ -66,7 +33,7 @@ int main() {
         int startId = graph.getNearestNode(srcLat, srcLon, walkDist);
         int endId = graph.getNearestNode(dstLat, dstLon, walkDist);
         
-        auto [path, dist] = shortestCarRoute(startId, endId);
+        auto [path, dist] = shortestCarRoute(graph, startId, endId);
         
         // Create separate output file for each test case
         ofstream outFile(basePath + "problem1/output_test" + to_string(t+1) + ".txt");
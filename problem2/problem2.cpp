@@ -1,103 +1,17 @@
 // Problem 2: Cheapest Cost (Car + Metro Only)
-#include "../common/graph.h"
+#include "../common/routing.h"
+#include "../common/snapshot.h"
 
 Graph graph;
 
-struct CostResult {
-    vector<int> path;
-    vector<int> modes;
-    double cost;
-};
-
-// Dijkstra's algorithm for cheapest route
-CostResult cheapestRoute(int start, int end, double costPerKm[4], bool allowed[4]) {
-    int n = graph.nodeCount;
-    vector<double> cost(n, INF);
-    vector<pair<int,int>> parent(n, {-1, -1}); // {prev node, mode}
-    priority_queue<pair<double,int>, vector<pair<double,int>>, greater<pair<double,int>>> pq;
-    
-    cost[start] = 0;
-    pq.push({0, start});
-    
-    while (!pq.empty()) {
-        auto [c, u] = pq.top();
-        pq.pop();
-        
-        if (c > cost[u]) continue;
-        if (u == end) break;
-        
-        for (auto& e : graph.adj[u]) {
-            if (!allowed[e.mode]) continue;
-            double edgeCost = e.dist * costPerKm[e.mode];
-            double newCost = cost[u] + edgeCost;
-            if (newCost < cost[e.to]) {
-                cost[e.to] = newCost;
-                parent[e.to] = {u, e.mode};
-                pq.push({newCost, e.to});
-            }
-        }
-    }
-    
-    if (cost[end] >= INF) return {{}, {}, -1};
-    
-    vector<int> path, modes;
-    for (int v = end; v != -1; v = parent[v].first) {
-        path.push_back(v);
-        if (parent[v].first != -1) modes.push_back(parent[v].second);
-    }
-    reverse(path.begin(), path.end());
-    reverse(modes.begin(), modes.end());
-    return {path, modes, cost[end]};
-}
-
-void printRoute(ofstream& outFile, CostResult& res, double costPerKm[4]) {
-    if (res.cost < 0) {
-        outFile << "No route found!\n";
-        return;
-    }
-    
-    double totalDist = 0, totalCost = 0;
-    
-    int i = 0;
-    while (i < (int)res.path.size() - 1) {
-        int startNode = res.path[i];
-        int mode = res.modes[i];
-        
-        int j = i;
-        double segDist = 0;
-        while (j < (int)res.path.size() - 1 && res.modes[j] == mode) {
-            double d = haversine(graph.nodes[res.path[j]].lat, graph.nodes[res.path[j]].lon,
-                                graph.nodes[res.path[j+1]].lat, graph.nodes[res.path[j+1]].lon);
-            segDist += d;
-            j++;
-        }
-        
-        int endNode = res.path[j];
-        double segCost = segDist * costPerKm[mode];
-        totalDist += segDist;
-        totalCost += segCost;
-        
-        string action = (mode == 0) ? "Drive Car" : "Ride " + getModeName(mode);
-        outFile << fixed << setprecision(2);
-        outFile << "Cost: Tk " << segCost << ": " << action;
-        outFile << " from (" << fixed << setprecision(6) << graph.nodes[startNode].lon << ", " << graph.nodes[startNode].lat << ")";
-        outFile << " to (" << graph.nodes[endNode].lon << ", " << graph.nodes[endNode].lat << ").\n";
-        
-        i = j;
-    }
-    
-    outFile << "\n";
-    outFile << fixed << setprecision(2);
-    outFile << "Total Distance: " << totalDist << " km\n";
-    outFile << "Total Cost: Tk " << totalCost << "\n";
-}
-
 int main() {
     string basePath = "/media/nym/Nym_s Files/grph-project/";
     
     cout << "Loading data for Problem 2...\n";
-    loadRoads(graph, basePath + "Roadmap-Dhaka.csv");
-    loadTransport(graph, basePath + "Routemap-DhakaMetroRail.csv", 1);
+    loadGraph(graph, {
+        {basePath + "Roadmap-Dhaka.csv", 0},
+        {basePath + "Routemap-DhakaMetroRail.csv", 1}
+    }, basePath + "problem2/graph.snap");
     cout << "Loaded " << graph.nodeCount << " nodes\n\n";
     
     // Test inputs from dataset
@@ -124,7 +38,7 @@ int main() {
         int startId = graph.getNearestNode(srcLat, srcLon, walkDist);
         int endId = graph.getNearestNode(dstLat, dstLon, walkDist);
         
-        CostResult res = cheapestRoute(startId, endId, costPerKm, allowed);
+        CostResult res = cheapestRoute(graph, startId, endId, costPerKm, allowed);
         
         // Create separate output file for each test case
         ofstream outFile(basePath + "problem2/output_test" + to_string(t+1) + ".txt");
@@ -134,7 +48,7 @@ int main() {
         outFile << "Source: (" << srcLon << ", " << srcLat << ")\n";
         outFile << "Destination: (" << dstLon << ", " << dstLat << ")\n\n";
         
-        printRoute(outFile, res, costPerKm);
+        printRoute(outFile, graph, res, costPerKm);
         
         if (!res.path.empty()) {
             saveKML(graph, res.path, basePath + "problem2/output_test" + to_string(t+1) + ".kml");
@@ -0,0 +1,122 @@
+// Matrix: cost between every source and every target, written as CSV or binary
+//
+// usage: matrix [--type car|metro|all] [--threads N] [--ch] [dataDir] sources targets outFile
+//   sources and targets are files with one "lon lat" per line (blank lines and lines
+//   starting with # are skipped, points snap like router queries), or one of metro,
+//   bikalpa, uttara for every stop of that mode.
+//   --type picks the costs of the router query type (default all): km for car,
+//   Tk for metro and all.
+//   --threads N spreads the sources over N threads (default 0 = all cores).
+//   --ch answers car matrices with the contraction hierarchy in dataDir/graph.ch and
+//   buckets instead of one Dijkstra per source.
+//   outFile ending in .bin gets the binary layout of saveMatrixBinary, anything else CSV.
+#include "../common/matrix.h"
+#include "../common/query.h"
+#include <chrono>
+
+// the nodes named by a matrix argument, see usage; false if it cannot be read
+bool readNodes(Graph& graph, const string& arg, int modeMask, vector<int>& nodes) {
+    int m = modeByName(arg);
+    if (m > 0) {
+        for (int u = 0; u < graph.nodeCount; u++) {
+            if (graph.nodes[u].isStop && (graph.nodeModes(u) & modeBit(m))) nodes.push_back(u);
+        }
+        return true;
+    }
+    
+    ifstream file(arg);
+    if (!file) return false;
+    string line;
+    while (getline(file, line)) {
+        string t = trim(line);
+        if (t.empty() || t[0] == '#') continue;
+        double lon, lat, walkDist;
+        if (!(stringstream(t) >> lon >> lat)) return false;
+        int u = graph.getNearestNode(lat, lon, walkDist, modeMask);
+        if (u < 0) return false;
+        nodes.push_back(u);
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    string basePath = "/media/nym/Nym_s Files/grph-project/";
+    int type = Q_ALL;
+    int threads = 0;
+    bool useCH = false;
+    
+    vector<string> args;
+    for (int i = 1; i < argc; i++) {
+        string a = argv[i];
+        if (a == "--ch") useCH = true;
+        else if (a == "--threads" && i + 1 < argc) threads = atoi(argv[++i]);
+        else if (a == "--type" && i + 1 < argc) {
+            string name = argv[++i];
+            type = -1;
+            for (int k : {Q_CAR, Q_METRO, Q_ALL}) {
+                if (name == queryParams(k).name) type = k;
+            }
+            if (type < 0) {
+                cerr << "Unknown matrix type " << name << "\n";
+                return 1;
+            }
+        }
+        else args.push_back(a);
+    }
+    if (args.size() == 4) {
+        basePath = args[0];
+        args.erase(args.begin());
+    }
+    if (args.size() != 3) {
+        cerr << "usage: matrix [--type car|metro|all] [--threads N] [--ch] [dataDir] sources targets outFile\n";
+        return 1;
+    }
+    if (!basePath.empty() && basePath.back() != '/') basePath += "/";
+    
+    auto t0 = chrono::steady_clock::now();
+    Graph graph;
+    loadGraph(graph, {
+        {basePath + "Roadmap-Dhaka.csv", 0},
+        {basePath + "Routemap-DhakaMetroRail.csv", 1},
+        {basePath + "Routemap-BikolpoBus.csv", 2},
+        {basePath + "Routemap-UttaraBus.csv", 3}
+    }, basePath + "graph.snap");
+    if (graph.nodeCount == 0) {
+        cerr << "No graph data found in " << basePath << "\n";
+        return 1;
+    }
+    
+    const QueryParams& p = queryParams(type);
+    vector<int> sources, targets;
+    if (!readNodes(graph, args[0], p.modeMask(), sources) || !readNodes(graph, args[1], p.modeMask(), targets)) {
+        cerr << "Cannot read " << (sources.empty() ? args[0] : args[1]) << "\n";
+        return 1;
+    }
+    
+    ContractionHierarchy ch;
+    if (useCH && type == Q_CAR) loadOrBuildCH(ch, graph, basePath + "graph.ch");
+    auto t1 = chrono::steady_clock::now();
+    
+    CostMatrix mat;
+    if (!ch.empty()) mat = chMatrix(ch, sources, targets, threads);
+    else if (type == Q_CAR) mat = costMatrix(graph, sources, targets, CAR_PER_KM, CAR_ONLY, threads);
+    else mat = costMatrix(graph, sources, targets, p.costPerKm, p.allowed, threads);
+    auto t2 = chrono::steady_clock::now();
+    
+    string out = args[2];
+    bool binary = out.size() >= 4 && out.compare(out.size() - 4, 4, ".bin") == 0;
+    if (!(binary ? saveMatrixBinary(graph, mat, out) : saveMatrixCSV(graph, mat, out))) {
+        cerr << "Cannot write " << out << "\n";
+        return 1;
+    }
+    
+    int missing = 0;
+    for (double c : mat.cost) missing += c < 0;
+    double secs = chrono::duration<double>(t2 - t1).count();
+    cerr << sources.size() << " x " << targets.size() << " " << p.name << " matrix ("
+         << (ch.empty() ? "one search per source" : "hierarchy buckets") << ") in " << fixed << setprecision(3)
+         << secs << " s, " << setprecision(0) << (secs > 0 ? mat.cost.size() / secs : 0) << " entries/s, "
+         << missing << " without a route; setup " << setprecision(1)
+         << chrono::duration<double, milli>(t1 - t0).count() << " ms\n";
+    return 0;
+}
@@ -0,0 +1,326 @@
+// Router: loads the Dhaka graph once and answers a stream of queries
+//
+// usage: router [--routes] [--threads N] [--algo dijkstra|astar|bidir] [--queue binary|quad|radix] [--ch] [--crp]
+//               [--compress] [--labels] [--cache MB] [--cache-trees N] [--kml FILE | --geojson FILE] [dataDir] [queryFile]
+//   queries are read from queryFile, or stdin when it is omitted (see common/query.h
+//   for the format); blank lines and lines starting with # are skipped.
+//   --routes also prints the full segment listing of every answer.
+//   --threads N reads all queries first and answers them as one batch on N threads
+//   (0 = all cores); otherwise each query is answered as soon as it is read.
+//   --algo picks the search used for car / metro / all queries (default dijkstra);
+//   every answer reports how many nodes the search settled.
+//   --queue picks the priority queue of the node searches (default binary, see
+//   common/heap.h); the timed label searches keep their own.
+//   --ch answers car queries with the contraction hierarchy in dataDir/graph.ch,
+//   building and writing it first if it is missing or was built for other data. A car
+//   edge update throws it away (its shortcuts cannot be repaired in place) and a new
+//   one is built in memory on another thread, which takes seconds; car queries use
+//   the --crp metrics, which follow updates cell by cell, or the --algo search until
+//   it is ready.
+//   --crp answers car / metro / all queries with customizable route planning
+//   (common/crp.h): one partition, customized for each of their price tables at
+//   startup and again, cell by cell, after edge updates. Car queries use the
+//   hierarchy instead when there is one; --crp takes precedence over --compress.
+//   --compress answers car / metro / all queries on the graph with its degree-2 chains
+//   compressed (common/compress.h), built at startup, with the --algo search; car
+//   queries use the hierarchy instead when there is one.
+//   Timed / fastest / deadline queries are answered from one Pareto search over
+//   (arrival time, cost), reporting the frontier size and the labels it created;
+//   --labels uses the one-label-per-node searches instead, which are several times
+//   faster but can miss the cheapest timed route (--pareto is the default).
+//   --cache MB keeps answers of repeated queries in an LRU cache of about MB megabytes
+//   (common/cache.h); --cache-trees N gives a node a one-to-all tree for car / metro /
+//   all queries after N misses there (default 4, 0 = never). Hits and misses are
+//   reported at the end.
+//   --kml / --geojson write the route of every answer into one KML or GeoJSON document
+//   (common/output.h), named after its query line; FILE - writes the document to
+//   stdout in place of the text answers.
+//   The transit routes for transit queries are built once, before the first one.
+//   Lines starting with close, reopen or factor change road or transit edges for the
+//   queries after them (see common/update.h for the format); consecutive ones are
+//   applied as one batch, which keeps the cache, transit routes, CRP metrics and
+//   compressed graph up to date and starts rebuilding the contraction hierarchy if a
+//   car edge changed. Nodes left with no open edge are no longer snapped to. Batch mode
+//   answers the queries read so far before applying them.
+//   Built with -DROUTE_STATS, the router also prints each query's search statistics
+//   (common/stats.h) to stderr as it answers it, and histograms of all of them at the
+//   end; batch mode prints only the histograms.
+#include "../common/batch.h"
+#include "../common/snapshot.h"
+#include "../common/update.h"
+#include <chrono>
+
+int main(int argc, char** argv) {
+    string basePath = "/media/nym/Nym_s Files/grph-project/";
+    string queryFile;
+    bool printRoutes = false;
+    int threads = -1;
+    int algo = ALGO_DIJKSTRA;
+    int queue = QUEUE_BINARY;
+    bool useCH = false;
+    bool useCRP = false;
+    bool useCompressed = false;
+    bool pareto = true;
+    double cacheMB = 0;
+    int cacheTrees = 4;
+    string docFile;
+    int docFormat = FORMAT_KML;
+    
+    vector<string> args;
+    for (int i = 1; i < argc; i++) {
+        string a = argv[i];
+        if (a == "--routes") printRoutes = true;
+        else if (a == "--ch") useCH = true;
+        else if (a == "--crp") useCRP = true;
+        else if (a == "--compress") useCompressed = true;
+        else if (a == "--pareto") pareto = true;
+        else if (a == "--labels") pareto = false;
+        else if (a == "--threads" && i + 1 < argc) threads = atoi(argv[++i]);
+        else if (a == "--cache" && i + 1 < argc) cacheMB = atof(argv[++i]);
+        else if (a == "--cache-trees" && i + 1 < argc) cacheTrees = atoi(argv[++i]);
+        else if ((a == "--kml" || a == "--geojson") && i + 1 < argc) {
+            docFile = argv[++i];
+            docFormat = a == "--kml" ? FORMAT_KML : FORMAT_GEOJSON;
+        }
+        else if (a == "--algo" && i + 1 < argc) {
+            string name = argv[++i];
+            algo = -1;
+            for (int k = ALGO_DIJKSTRA; k <= ALGO_BIDIR_ASTAR; k++) {
+                if (name == algoName(k)) algo = k;
+            }
+            if (algo < 0) {
+                cerr << "Unknown search algorithm " << name << "\n";
+                return 1;
+            }
+        }
+        else if (a == "--queue" && i + 1 < argc) {
+            string name = argv[++i];
+            queue = -1;
+            for (int k = QUEUE_BINARY; k <= QUEUE_RADIX; k++) {
+                if (name == queueName(k)) queue = k;
+            }
+            if (queue < 0) {
+                cerr << "Unknown priority queue " << name << "\n";
+                return 1;
+            }
+        }
+        else args.push_back(a);
+    }
+    if (args.size() > 0) basePath = args[0];
+    if (!basePath.empty() && basePath.back() != '/') basePath += "/";
+    if (args.size() > 1) queryFile = args[1];
+    
+    auto t0 = chrono::steady_clock::now();
+    Graph graph;
+    bool fromSnapshot = loadGraph(graph, {
+        {basePath + "Roadmap-Dhaka.csv", 0},
+        {basePath + "Routemap-DhakaMetroRail.csv", 1},
+        {basePath + "Routemap-BikolpoBus.csv", 2},
+        {basePath + "Routemap-UttaraBus.csv", 3}
+    }, basePath + "graph.snap");
+    if (graph.nodeCount == 0) {
+        cerr << "No graph data found in " << basePath << "\n";
+        return 1;
+    }
+    graph.buildSpatialIndex();
+    auto t1 = chrono::steady_clock::now();
+    cerr << "Loaded " << graph.nodeCount << " nodes from " << (fromSnapshot ? "snapshot" : "CSV") << " in "
+         << fixed << setprecision(1) << chrono::duration<double, milli>(t1 - t0).count() << " ms\n";
+    
+    ContractionHierarchy ch;
+    if (useCH) {
+        bool fromFile = loadOrBuildCH(ch, graph, basePath + "graph.ch");
+        auto t2 = chrono::steady_clock::now();
+        cerr << (fromFile ? "Loaded" : "Built") << " contraction hierarchy (" << ch.shortcutCount() << " shortcuts) in "
+             << chrono::duration<double, milli>(t2 - t1).count() << " ms\n";
+        t1 = t2;
+    }
+    CompressedGraph compressed;
+    if (useCompressed) {
+        compressed.build(graph);
+        auto t2 = chrono::steady_clock::now();
+        cerr << "Compressed " << compressed.chainCount() << " chains, " << compressed.keptCount << " of "
+             << graph.nodeCount << " nodes kept, in " << chrono::duration<double, milli>(t2 - t1).count() << " ms\n";
+        t1 = t2;
+    }
+    const CompressedGraph* compressedPtr = useCompressed ? &compressed : nullptr;
+    CRPTables crp;
+    if (useCRP) {
+        crp.build(graph);
+        auto t2 = chrono::steady_clock::now();
+        cerr << "Partitioned into " << crp.part.cellCount[0] << " cells and customized 3 price tables in "
+             << chrono::duration<double, milli>(t2 - t1).count() << " ms\n";
+        t1 = t2;
+    }
+    const CRPTables* crpPtr = useCRP ? &crp : nullptr;
+    
+    ifstream file;
+    if (!queryFile.empty()) {
+        file.open(queryFile);
+        if (!file) {
+            cerr << "Cannot open " << queryFile << "\n";
+            return 1;
+        }
+    }
+    istream& in = queryFile.empty() ? cin : file;
+    
+    QueryCache cache((size_t)(cacheMB * (1 << 20)), cacheTrees);
+    QueryCache* cachePtr = cacheMB > 0 ? &cache : nullptr;
+    
+    unique_ptr<RouteWriter> doc;
+    if (!docFile.empty()) {
+        doc.reset(new RouteWriter(docFile, docFormat, "Routes for " + (queryFile.empty() ? string("stdin") : queryFile)));
+        if (!doc->ok()) {
+            cerr << "Cannot write " << docFile << "\n";
+            return 1;
+        }
+    }
+    ostream& text = docFile == "-" ? cerr : cout;
+    
+    // the answer to one query line, as text and into the document
+    auto report = [&](int lineNo, const Query& q, const QueryResult& r) {
+        string summary = formatResult(q, r);
+        if (docFile != "-") {
+            cout << "line " << lineNo << ": " << summary << "\n";
+            if (printRoutes) {
+                printQueryRoute(cout, graph, q, r);
+                cout << "\n";
+            }
+        }
+        if (doc && r.found && !r.path.empty()) doc->addRoute(graph, r.path, "line " + to_string(lineNo), summary);
+    };
+    
+    TransitNetwork transit;
+    auto needTransit = [&](const Query& q) {
+        if (q.type != Q_TRANSIT || transit.stopCount() > 0) return;
+        auto b0 = chrono::steady_clock::now();
+        transit.build(graph);
+        cerr << "Built " << transit.routeCount() << " transit routes over " << transit.stopCount() << " stops in "
+             << fixed << setprecision(1) << chrono::duration<double, milli>(chrono::steady_clock::now() - b0).count()
+             << " ms\n";
+    };
+    // the hierarchy rebuilt after car edge updates, once it is ready
+    CHRebuilder rebuilder;
+    auto takeCH = [&]() {
+        double ms;
+        if (!rebuilder.take(ch, graph, ms)) return;
+        cerr << "Rebuilt the contraction hierarchy (" << ch.shortcutCount() << " shortcuts) for the changed edges in "
+             << fixed << setprecision(1) << ms << " ms\n";
+    };
+    
+    int answered = 0, lineNo = 0;
+    double searchSecs = 0;
+    vector<Query> batch;
+    vector<int> batchLines;
+    
+    // the queries read so far in batch mode
+    auto answerQueued = [&]() {
+        for (auto& q : batch) needTransit(q);
+        takeCH();
+        auto s0 = chrono::steady_clock::now();
+        vector<QueryResult> results = answerBatch(graph, batch, threads, algo, &ch, &transit, pareto, queue, cachePtr,
+                                                   compressedPtr, crpPtr);
+        searchSecs += chrono::duration<double>(chrono::steady_clock::now() - s0).count();
+        answered += batch.size();
+        for (size_t i = 0; i < batch.size(); i++) {
+            STATS(beginQueryStats());
+            report(batchLines[i], batch[i], results[i]);
+            STATS(endQueryStats());
+        }
+        batch.clear();
+        batchLines.clear();
+    };
+    
+    GraphUpdater updater(graph);
+    updater.cache = cachePtr;
+    updater.ch = &ch;
+    updater.transit = &transit;
+    if (useCompressed) updater.compressed = &compressed;
+    if (useCRP) updater.metrics = {&crp.metrics[Q_CAR], &crp.metrics[Q_METRO], &crp.metrics[Q_ALL]};
+    vector<EdgeUpdate> updates;
+    int firstUpdate = 0, lastUpdate = 0;
+    auto applyUpdates = [&]() {
+        if (updates.empty()) return;
+        if (threads >= 0 && !batch.empty()) answerQueued();
+        bool hadCH = !ch.empty();
+        UpdateResult res = updater.apply(updates);
+        cerr << "lines " << firstUpdate << "-" << lastUpdate << ": " << res.changed << " of " << updates.size()
+             << " updates changed " << res.slots << " edge slots in " << fixed << setprecision(3) << res.graphMs
+             << " ms, then " << res.dependentMs << " ms to drop " << res.dropped << " cached answers and recompute "
+             << res.cells << " CRP cells, " << res.chains << " compressed chains and " << res.transitRows
+             << " transit car rows\n";
+        if (hadCH && ch.empty()) {
+            cerr << "Car edges changed: rebuilding the contraction hierarchy in the background\n";
+        }
+        if (useCH && ch.empty()) rebuilder.start(graph);
+        updates.clear();
+    };
+    
+    SearchWorkspace ws;
+    ws.queue = queue;
+    string line;
+    while (getline(in, line)) {
+        lineNo++;
+        string t = trim(line);
+        if (t.empty() || t[0] == '#') continue;
+        
+        string error;
+        if (isUpdateLine(t)) {
+            EdgeUpdate up;
+            if (!parseUpdate(graph, t, up, error)) {
+                text << "line " << lineNo << ": error: " << error << "\n";
+                continue;
+            }
+            if (updates.empty()) firstUpdate = lineNo;
+            lastUpdate = lineNo;
+            updates.push_back(up);
+            continue;
+        }
+        
+        Query q;
+        if (!parseQuery(t, q, error)) {
+            text << "line " << lineNo << ": error: " << error << "\n";
+            continue;
+        }
+        applyUpdates();
+        
+        if (threads >= 0) {
+            batch.push_back(q);
+            batchLines.push_back(lineNo);
+            continue;
+        }
+        
+        needTransit(q);
+        takeCH();
+        STATS(beginQueryStats());
+        auto s0 = chrono::steady_clock::now();
+        QueryResult r = answerCached(graph, q, ws, cachePtr, algo, &ch, &transit, pareto, compressedPtr, crpPtr);
+        searchSecs += chrono::duration<double>(chrono::steady_clock::now() - s0).count();
+        answered++;
+        
+        report(lineNo, q, r);
+        STATS(cerr << "line " << lineNo << " stats: " << formatStats(threadStats()) << "\n");
+        STATS(endQueryStats());
+    }
+    
+    applyUpdates();
+    if (threads >= 0) answerQueued();
+    
+    if (doc) {
+        doc->close();
+        cerr << "Wrote " << doc->routes() << " routes to " << (docFile == "-" ? "stdout" : docFile) << "\n";
+    }
+    
+    double totalSecs = chrono::duration<double>(chrono::steady_clock::now() - t1).count();
+    cerr << "Answered " << answered << " queries in " << fixed << setprecision(3) << totalSecs << " s ("
+         << setprecision(1) << (totalSecs > 0 ? answered / totalSecs : 0) << " queries/s, "
+         << setprecision(3) << (answered > 0 ? searchSecs * 1000 / answered : 0) << " ms search per query"
+         << (threads >= 0 ? ", wall clock" : "") << ")\n";
+    if (cachePtr) {
+        cerr << "Cache: " << cache.hits << " hits, " << cache.treeHits << " tree hits, " << cache.misses << " misses, "
+             << cache.trees << " trees, " << cache.evictions << " evictions, " << cache.entries() << " entries in "
+             << setprecision(1) << cache.bytes() / 1048576.0 << " MB\n";
+    }
+    STATS(dumpStats(cerr));
+    return 0;
+}